@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+#include "BacktestAgent.h"
+
+/*
+ * AgentPopulation Class
+ *
+ * A population of agents trading one book, stored as parallel arrays (structure of arrays) instead
+ * of one BacktestAgent object each: an agent is an index into the seed, cash and holdings arrays,
+ * plus its pending orders. A tick is one loop over the arrays, so a large population streams
+ * through a few dense arrays rather than a heap of agent objects, each with its own book reference,
+ * trade buffer and hash set.
+ *
+ * Pending orders are kept in one shared node pool: each agent's pending order ids form a stack
+ * (most recent on top) threaded through the pool by index, so an agent with no pending orders
+ * costs only its stack head and freed nodes are reused by any agent.
+ *
+ * Agents decide through the same BacktestAgent planIntent/getActionDetails/updatePosition as the
+ * object engine, so a population makes the same orders, in the same order, as a vector of
+ * BacktestAgents with the same seeds stepped serially.
+ */
+class AgentPopulation {
+public:
+    AgentPopulation(Orderbook& orderbook);
+    void reserve(std::size_t agents);
+    std::size_t addAgent(Lehmer32_t seed);
+    void step(Lehmer32_t timeStep);
+    std::size_t size() const;
+    Cash getCash(std::size_t agent) const;
+    Holdings getHoldings(std::size_t agent) const;
+    std::size_t getNumPendingOrders(std::size_t agent) const;
+
+private:
+    using PendingIndex = std::uint32_t;
+    static constexpr PendingIndex NO_PENDING = std::numeric_limits<PendingIndex>::max();
+
+    Orderbook& orderbook;
+    Trades trades; // reused for every add/modify
+
+    // per agent
+    std::vector<Lehmer32_t> seeds;
+    std::vector<Cash> cash;
+    std::vector<Holdings> holdings;
+    std::vector<PendingIndex> pendingHeads; // top of the agent's pending order stack
+
+    // pending order nodes shared by every agent
+    std::vector<OrderId> pendingOrderIds;
+    std::vector<PendingIndex> pendingNext;
+    PendingIndex freePending = NO_PENDING;
+
+    void pushPending(std::size_t agent, OrderId orderId);
+    OrderId popPending(std::size_t agent);
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "BacktestAgent.h"
+#include "ThreadPool.h"
+
+/*
+ * AgentSimulation Class
+ *
+ * Steps a population of agents one tick at a time. In serial mode (one thread) every agent runs
+ * generateAction in turn. With more threads, each tick is run in two phases:
+ * - every agent plans its intent (action and random draws) in parallel across the thread pool
+ * - the intents are applied to the book one agent at a time, in agent order
+ *
+ * Planning only depends on each agent's own state and every price is read from the book when the
+ * intent is applied, so the book ends up bit-identical to serial mode.
+ */
+class AgentSimulation {
+public:
+    AgentSimulation(std::vector<BacktestAgent>& agents, std::size_t numThreads = 1);
+    void step(Lehmer32_t timeStep);
+
+private:
+    std::vector<BacktestAgent>& agents;
+    std::vector<AgentIntent> intents;
+    std::unique_ptr<ThreadPool> pool; // nullptr in serial mode
+};
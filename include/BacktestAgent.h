@@ -1,6 +1,7 @@
 // BacktestAgent.h
 #pragma once
-#include <unordered_set>
+#include <array>
+#include <vector>
 #include "RandomNumber.h"
 #include "Orderbook.h"
 #include "Order.h"
@@ -26,6 +27,20 @@ enum class ActionType {
     ModifyOrder
 };
 
+// random draws made by an action (side, bias, opposite bias chance, quantity, order type)
+const std::size_t MAX_ACTION_DRAWS = 5;
+
+/*
+ * The decision an agent makes for a time step: which action to take and the random draws it uses.
+ * Planning only reads the agent's own state, so intents for different agents can be planned in
+ * parallel. Prices and quantities are worked out from the draws when the intent is applied.
+ */
+struct AgentIntent {
+    bool hasAction = false;
+    ActionType action = ActionType::AddOrder;
+    std::array<Lehmer32_t, MAX_ACTION_DRAWS> draws{};
+};
+
 struct Action {
     ActionType action;
     Price price;
@@ -34,27 +49,41 @@ struct Action {
     OrderType orderType;
 };
 
-using PendingOrders = std::unordered_set<OrderId>;
+// pending order ids, most recently placed last (cancels and modifies take the most recent)
+using PendingOrders = std::vector<OrderId>;
 using Cash = double;
 using Holdings = int;
 
 class BacktestAgent {
 private:
-    RandomNumber rn;
     Lehmer32_t seed;
     Orderbook& orderbook;
     Cash cash = STARTING_CASH;
     Holdings holdings = 0;
     PendingOrders orders;
+    Trades trades; // reused for every add/modify so no trade storage is allocated per action
 
     Price getBestPrice(Side side);
     void addOrder(Action action);
     void modifyOrder(const OrderId orderId, Action action);
     void cancelOrder(const OrderId orderId);
-    Action generateActionDetails(ActionType actionType);
-    Price getBiasedPrice(Side side);
+    static Price getBestPrice(Orderbook& orderbook, Side side);
+    static Price getBiasedPrice(Orderbook& orderbook, Side side, Lehmer32_t biasDraw, Lehmer32_t oppositeBiasDraw);
 
 public:
     BacktestAgent(Lehmer32_t seed, Orderbook& orderbook);
     void generateAction(Lehmer32_t timeStep);
+    AgentIntent planAction(Lehmer32_t timeStep);
+    void applyIntent(const AgentIntent& intent);
+    Cash getCash() const;
+    Holdings getHoldings() const;
+    std::size_t getNumPendingOrders() const;
+
+    /*
+    * The agent's decisions, from its state passed in rather than held, so any agent engine (e.g. the
+    * AgentPopulation arrays) makes exactly the same ones.
+    */
+    static AgentIntent planIntent(Lehmer32_t seed, Lehmer32_t timeStep, bool hasPendingOrders);
+    static Action getActionDetails(const AgentIntent& intent, Cash cash, Holdings holdings, Orderbook& orderbook);
+    static void updatePosition(const Action& action, Cash& cash, Holdings& holdings);
 };
\ No newline at end of file
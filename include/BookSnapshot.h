@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include "Types.h"
+#include "Side.h"
+#include "OrderType.h"
+
+/*
+ * Binary book snapshot format
+ *
+ * A BookSnapshotHeader followed by one SnapshotOrder per resting order (native byte order). Orders
+ * are written bids first then asks, best price first, and in time priority within a level, so a
+ * restore only has to append each order to the back of its level.
+ */
+const char BOOK_SNAPSHOT_MAGIC[4] = {'O', 'B', 'S', 'N'};
+const std::uint32_t BOOK_SNAPSHOT_VERSION = 1;
+
+struct BookSnapshotHeader {
+    char magic[4];
+    std::uint32_t version;
+    OrderId nextOrderId;        // id the next new order will get
+    std::uint64_t poolCapacity; // orders the pool held, reserved up front on restore
+    std::uint64_t orderCount;   // SnapshotOrders following the header
+};
+
+static_assert(sizeof(BookSnapshotHeader) == 32, "BookSnapshotHeader must be fixed width");
+
+struct SnapshotOrder {
+    OrderId orderId;
+    Price price;
+    Quantity initialQuantity;
+    Quantity remainingQuantity;
+    Side side;
+    OrderType orderType;
+    std::uint8_t reserved[2];
+};
+
+static_assert(sizeof(SnapshotOrder) == 24, "SnapshotOrder must be fixed width");
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include "Types.h"
+#include "Side.h"
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define DEPTH_KERNELS_AVX2 1
+#endif
+
+/*
+ * Depth kernels
+ *
+ * Liquidity queries over a contiguous array of per-tick quantities, ordered outwards from the
+ * touch (index 0 is the best price, index j is j ticks away from it, empty ticks hold 0).
+ *
+ * Each kernel has a scalar version and an AVX2 version (8 ticks per step, widened to 64-bit
+ * accumulators so deep bands can't overflow). The AVX2 code is compiled for that target on its own,
+ * so the rest of the build needs no -mavx2, and it is picked at run time when the CPU supports it.
+ */
+
+/*
+ * What a sweep of a side would take: the quantity filled (less than asked if the side runs out),
+ * its notional (sum of price * quantity) and the worst price reached.
+ */
+struct SweepCost {
+    Quantity quantity = 0;
+    std::int64_t notional = 0;
+    Price worstPrice = 0;
+
+    double getVwap() const {
+        return quantity == 0 ? 0.0 : static_cast<double>(notional) / static_cast<double>(quantity);
+    }
+};
+
+/*
+ * Add what a sweep takes from one level (best first) until quantity is filled.
+ */
+inline void takeLevel(SweepCost& cost, Price price, Quantity levelQuantity, Quantity quantity) {
+    Quantity taken = std::min(levelQuantity, quantity - cost.quantity);
+    cost.quantity += taken;
+    cost.notional += static_cast<std::int64_t>(price) * static_cast<std::int64_t>(taken);
+    cost.worstPrice = price;
+}
+
+/*
+ * The furthest price from bestPrice that is within ticks price ticks of it (bestPrice itself is 1 tick).
+ */
+inline Price bandLimit(Side side, Price bestPrice, std::size_t ticks) {
+    std::int64_t away = static_cast<std::int64_t>(std::min<std::size_t>(ticks, std::numeric_limits<std::uint32_t>::max())) - 1;
+    std::int64_t limit = (side == Side::Buy) ? bestPrice - away : bestPrice + away;
+    limit = std::max<std::int64_t>(limit, std::numeric_limits<Price>::min());
+    return static_cast<Price>(std::min<std::int64_t>(limit, std::numeric_limits<Price>::max()));
+}
+
+/*
+ * Sweep limits: a sweep of a side stops at the first level priced past limit (bids below it, asks
+ * above it). noPriceLimit lets a sweep run to the end of the side.
+ */
+inline bool withinLimit(Side side, Price price, Price limit) {
+    return (side == Side::Buy) ? price >= limit : price <= limit;
+}
+
+inline Price noPriceLimit(Side side) {
+    return (side == Side::Buy) ? std::numeric_limits<Price>::min() : std::numeric_limits<Price>::max();
+}
+
+/*
+ * A sweep over a tick array: quantity taken, sum of (tick index * quantity taken) and the number of
+ * ticks up to and including the last one taken from. With the price of the touch this gives the notional.
+ */
+struct SweepTotals {
+    std::uint64_t quantity = 0;
+    std::uint64_t weighted = 0;
+    std::size_t ticks = 0;
+};
+
+inline bool hasAvx2() {
+#if defined(DEPTH_KERNELS_AVX2)
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+inline std::uint64_t sumQuantitiesScalar(const Quantity* quantities, std::size_t count) {
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        total += quantities[i];
+    }
+    return total;
+}
+
+/*
+ * Take up to target from the ticks in order, starting at index first (totals continue from start).
+ */
+inline SweepTotals sweepQuantitiesScalar(const Quantity* quantities, std::size_t count, std::uint64_t target,
+                                         std::size_t first = 0, SweepTotals start = SweepTotals()) {
+    SweepTotals totals = start;
+    for (std::size_t i = first; i < count && totals.quantity < target; ++i) {
+        if (quantities[i] == 0) {
+            continue;
+        }
+        std::uint64_t taken = std::min<std::uint64_t>(quantities[i], target - totals.quantity);
+        totals.quantity += taken;
+        totals.weighted += taken * i;
+        totals.ticks = i + 1;
+    }
+    return totals;
+}
+
+#if defined(DEPTH_KERNELS_AVX2)
+__attribute__((target("avx2"))) inline std::uint64_t horizontalSum(__m256i values) {
+    __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(values), _mm256_extracti128_si256(values, 1));
+    return static_cast<std::uint64_t>(_mm_cvtsi128_si64(sum)) + static_cast<std::uint64_t>(_mm_extract_epi64(sum, 1));
+}
+
+__attribute__((target("avx2"))) inline std::uint64_t sumQuantitiesAvx2(const Quantity* quantities, std::size_t count) {
+    __m256i low = _mm256_setzero_si256();
+    __m256i high = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(quantities + i));
+        low = _mm256_add_epi64(low, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(block)));
+        high = _mm256_add_epi64(high, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(block, 1)));
+    }
+    return horizontalSum(_mm256_add_epi64(low, high)) + sumQuantitiesScalar(quantities + i, count - i);
+}
+
+/*
+ * Whole blocks of 8 ticks are taken while they fit under the target (their sum and index-weighted
+ * sum in one pass), the block that reaches the target is finished tick by tick.
+ */
+__attribute__((target("avx2"))) inline SweepTotals sweepQuantitiesAvx2(const Quantity* quantities, std::size_t count, std::uint64_t target) {
+    SweepTotals totals;
+    __m256i indexLow = _mm256_setr_epi64x(0, 1, 2, 3);
+    __m256i indexHigh = _mm256_setr_epi64x(4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi64x(8);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(quantities + i));
+        __m256i low = _mm256_cvtepu32_epi64(_mm256_castsi256_si128(block));
+        __m256i high = _mm256_cvtepu32_epi64(_mm256_extracti128_si256(block, 1));
+        std::uint64_t blockQuantity = horizontalSum(_mm256_add_epi64(low, high));
+        if (totals.quantity + blockQuantity >= target) {
+            break;
+        }
+        if (blockQuantity != 0) {
+            __m256i weighted = _mm256_add_epi64(_mm256_mul_epu32(low, indexLow), _mm256_mul_epu32(high, indexHigh));
+            totals.quantity += blockQuantity;
+            totals.weighted += horizontalSum(weighted);
+            // the last non-empty tick of the block
+            int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(block, _mm256_setzero_si256())));
+            totals.ticks = i + 8 - static_cast<std::size_t>(__builtin_clz(~mask & 0xff) - 24);
+        }
+        indexLow = _mm256_add_epi64(indexLow, step);
+        indexHigh = _mm256_add_epi64(indexHigh, step);
+    }
+    return sweepQuantitiesScalar(quantities, count, target, i, totals);
+}
+#endif
+
+/*
+ * Total quantity over the first count ticks.
+ */
+inline std::uint64_t sumQuantities(const Quantity* quantities, std::size_t count) {
+#if defined(DEPTH_KERNELS_AVX2)
+    if (hasAvx2()) {
+        return sumQuantitiesAvx2(quantities, count);
+    }
+#endif
+    return sumQuantitiesScalar(quantities, count);
+}
+
+/*
+ * Take up to target quantity from the ticks in order.
+ */
+inline SweepTotals sweepQuantities(const Quantity* quantities, std::size_t count, std::uint64_t target) {
+#if defined(DEPTH_KERNELS_AVX2)
+    if (hasAvx2()) {
+        return sweepQuantitiesAvx2(quantities, count, target);
+    }
+#endif
+    return sweepQuantitiesScalar(quantities, count, target);
+}
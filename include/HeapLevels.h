@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <unordered_map>
+#include "OrderLevel.h"
+#include "DepthKernels.h"
+#include "Side.h"
+
+/*
+ * HeapLevels Class
+ *
+ * Level index for the Orderbook backed by a max heap of bid levels and a min heap of ask levels,
+ * plus a map from price to level on each side for quick access when adding orders.
+ *
+ * Levels emptied by a cancel are not removed straight away, they are dropped once they reach the
+ * top of their heap (lazy deletion), so the level counts include these empty levels.
+ */
+class HeapLevels {
+public:
+    /*
+    * Whether a price can rest in the book (any price can).
+    */
+    bool contains(Price) const {
+        return true;
+    }
+
+    /*
+    * Get the level at a price, creating it if it doesn't exist.
+    */
+    OrderLevel& getOrCreate(Side side, Price price) {
+        auto& levels = (side == Side::Buy) ? bidLevels : askLevels;
+        auto it = levels.find(price);
+        if (it != levels.end()) {
+            return *it->second;
+        }
+
+        auto level = std::make_shared<OrderLevel>();
+        level->price = price;
+        levels[price] = level;
+        if (side == Side::Buy) {
+            bids.push_back(level);
+            std::push_heap(bids.begin(), bids.end(), BidComparator());
+        } else {
+            asks.push_back(level);
+            std::push_heap(asks.begin(), asks.end(), AskComparator());
+        }
+        return *level;
+    }
+
+    /*
+    * Get the best level on a side, or nullptr if the side is empty.
+    * Empty levels at the top of the heap are dropped here (lazy deletion).
+    */
+    OrderLevel* best(Side side) {
+        if (side == Side::Buy) {
+            return top(bids, bidLevels, BidComparator());
+        }
+        return top(asks, askLevels, AskComparator());
+    }
+
+    /*
+    * Remove the best level on a side, called once matching has emptied it.
+    */
+    void popBest(Side side) {
+        if (side == Side::Buy) {
+            pop(bids, bidLevels, BidComparator());
+        } else {
+            pop(asks, askLevels, AskComparator());
+        }
+    }
+
+    /*
+    * Called when a cancel empties a level. The level stays in the heap until it reaches the top.
+    */
+    void release(Side, OrderLevel&) {}
+
+    std::size_t size(Side side) const {
+        return (side == Side::Buy) ? bids.size() : asks.size();
+    }
+
+    /*
+    * Called whenever a level's aggregate changes (nothing to keep in step here).
+    */
+    void update(Side, const OrderLevel&) {}
+
+    /*
+    * Total quantity resting on a side within ticks price ticks of its best price (the best included).
+    */
+    std::uint64_t bandQuantity(Side side, std::size_t ticks) {
+        OrderLevel* level = best(side);
+        std::uint64_t total = 0;
+        if (level == nullptr || ticks == 0) {
+            return total;
+        }
+        forEachWithin(side, bandLimit(side, level->price, ticks), [&total](const OrderLevel& within) {
+            total += within.totalQuantity;
+        });
+        return total;
+    }
+
+    /*
+    * What taking quantity from a side, best price first and no further than limit, would fill and cost.
+    */
+    SweepCost sweep(Side side, Quantity quantity, Price limit) {
+        if (side == Side::Buy) {
+            return sweepHeap(bids, quantity, limit, [](Price lhs, Price rhs) { return lhs > rhs; });
+        }
+        return sweepHeap(asks, quantity, limit, [](Price lhs, Price rhs) { return lhs < rhs; });
+    }
+
+    /*
+    * Visit every level on a side from best to worst price (including empty levels).
+    */
+    template<typename Fn>
+    void forEach(Side side, Fn fn) const {
+        if (side == Side::Buy) {
+            visit(bids, BidComparator(), fn);
+        } else {
+            visit(asks, AskComparator(), fn);
+        }
+    }
+
+    /*
+    * Visit every non-empty level on a side priced at or better than limit (bids >= limit, asks <= limit),
+    * in no particular order. Children in a heap are never better than their parent, so the walk stops
+    * at the first level past the limit on each branch and only touches the levels it visits.
+    */
+    template<typename Fn>
+    void forEachWithin(Side side, Price limit, Fn fn) const {
+        if (side == Side::Buy) {
+            visitWithin(bids, 0, [limit](Price price) { return price >= limit; }, fn);
+        } else {
+            visitWithin(asks, 0, [limit](Price price) { return price <= limit; }, fn);
+        }
+    }
+
+    /*
+    * Write up to maxLevels non-empty levels on a side into out, from best to worst price.
+    * The heap is only partially ordered, so this selects the best levels with an insertion sort
+    * into out (no allocation). Returns the number of levels written.
+    */
+    std::size_t depth(Side side, LevelInfo* out, std::size_t maxLevels) const {
+        if (side == Side::Buy) {
+            return select(bids, out, maxLevels, [](Price lhs, Price rhs) { return lhs > rhs; });
+        }
+        return select(asks, out, maxLevels, [](Price lhs, Price rhs) { return lhs < rhs; });
+    }
+
+private:
+    // HEAPS - Allow for quick access to the best bid/ask
+    // max heap based on price
+    std::vector<OrderLevelPtr> bids;
+    // min heap based on price
+    std::vector<OrderLevelPtr> asks;
+
+    // MAPS - Allow for quick access to the level (add, remove, modify orders)
+    std::unordered_map<Price, OrderLevelPtr> bidLevels;
+    std::unordered_map<Price, OrderLevelPtr> askLevels;
+
+    // heap indexes queued by a sweep (cleared, not freed, so a sweep doesn't allocate once it has grown)
+    std::vector<std::size_t> frontier;
+
+    template<typename Comparator>
+    static OrderLevel* top(std::vector<OrderLevelPtr>& heap, std::unordered_map<Price, OrderLevelPtr>& levels, Comparator comparator) {
+        while (!heap.empty() && heap.front()->empty()) {
+            pop(heap, levels, comparator);
+        }
+        return heap.empty() ? nullptr : heap.front().get();
+    }
+
+    template<typename Comparator>
+    static void pop(std::vector<OrderLevelPtr>& heap, std::unordered_map<Price, OrderLevelPtr>& levels, Comparator comparator) {
+        levels.erase(heap.front()->price);
+        std::pop_heap(heap.begin(), heap.end(), comparator);
+        heap.pop_back();
+    }
+
+    template<typename Comparator, typename Fn>
+    static void visit(const std::vector<OrderLevelPtr>& heap, Comparator comparator, Fn& fn) {
+        auto copy = heap;
+        while (!copy.empty()) {
+            std::pop_heap(copy.begin(), copy.end(), comparator);
+            fn(static_cast<const OrderLevel&>(*copy.back()));
+            copy.pop_back();
+        }
+    }
+
+    template<typename Within, typename Fn>
+    static void visitWithin(const std::vector<OrderLevelPtr>& heap, std::size_t index, Within within, Fn& fn) {
+        if (index >= heap.size() || !within(heap[index]->price)) {
+            return;
+        }
+        if (!heap[index]->empty()) {
+            fn(static_cast<const OrderLevel&>(*heap[index]));
+        }
+        visitWithin(heap, 2 * index + 1, within, fn);
+        visitWithin(heap, 2 * index + 2, within, fn);
+    }
+
+    /*
+    * Best first walk of the heap: a level's children are only queued once it has been taken, so
+    * only the levels the sweep reaches (and their children) are touched. A child past the limit is
+    * never queued, its whole subtree is worse still.
+    */
+    template<typename Better>
+    SweepCost sweepHeap(const std::vector<OrderLevelPtr>& heap, Quantity quantity, Price limit, Better better) {
+        SweepCost cost;
+        frontier.clear();
+        auto worse = [&heap, &better](std::size_t lhs, std::size_t rhs) { return better(heap[rhs]->price, heap[lhs]->price); };
+        auto within = [&heap, &better, limit](std::size_t index) { return !better(limit, heap[index]->price); };
+        if (!heap.empty() && within(0)) {
+            frontier.push_back(0);
+        }
+        while (!frontier.empty() && cost.quantity < quantity) {
+            std::pop_heap(frontier.begin(), frontier.end(), worse);
+            std::size_t index = frontier.back();
+            frontier.pop_back();
+            if (!heap[index]->empty()) {
+                takeLevel(cost, heap[index]->price, heap[index]->totalQuantity, quantity);
+            }
+            for (std::size_t child = 2 * index + 1; child <= 2 * index + 2 && child < heap.size(); ++child) {
+                if (!within(child)) {
+                    continue;
+                }
+                frontier.push_back(child);
+                std::push_heap(frontier.begin(), frontier.end(), worse);
+            }
+        }
+        return cost;
+    }
+
+    template<typename Better>
+    static std::size_t select(const std::vector<OrderLevelPtr>& heap, LevelInfo* out, std::size_t maxLevels, Better better) {
+        std::size_t count = 0;
+        if (maxLevels == 0) {
+            return 0;
+        }
+        for (const auto& level : heap) {
+            if (level->empty() || (count == maxLevels && !better(level->price, out[count - 1].price))) {
+                continue;
+            }
+            std::size_t i = (count < maxLevels) ? count++ : count - 1;
+            while (i > 0 && better(level->price, out[i - 1].price)) {
+                out[i] = out[i - 1];
+                --i;
+            }
+            out[i] = level->getInfo();
+        }
+        return count;
+    }
+};
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Types.h"
+#include "Side.h"
+#include "OrderType.h"
+
+// JOURNAL SETTINGS
+const std::size_t JOURNAL_BUFFER_RECORDS = 1 << 16; // records per buffer (2MB), one write() each
+
+/*
+ * Binary journal format
+ *
+ * A JournalFileHeader followed by packed fixed-width JournalRecords (native byte order), one per
+ * book event in the order the book handled them. The header carries no count, the records run to
+ * the end of the file.
+ */
+enum class JournalRecordType : std::uint8_t {
+    Add,    // orderId is the new order's id
+    Cancel, // orderId is the cancelled order
+    Modify, // orderId is the old order, otherOrderId the replacement (the same id for an in-place amend)
+    Reject, // orderId was rejected (follows its Add or Modify)
+    Trade,  // orderId/price are the bid leg, otherOrderId/otherPrice the ask leg
+    Stop,      // orderId is the new stop's id, price its limit and otherPrice its trigger price
+    StopCancel // orderId is the cancelled stop
+};
+
+struct JournalRecord {
+    JournalRecordType recordType;
+    Side side;
+    OrderType orderType;
+    std::uint8_t reserved;
+    Price price;
+    Quantity quantity;
+    Price otherPrice;
+    OrderId orderId;
+    OrderId otherOrderId;
+};
+
+static_assert(sizeof(JournalRecord) == 32, "JournalRecord must be fixed width");
+
+const char JOURNAL_MAGIC[4] = {'O', 'B', 'J', 'L'};
+const std::uint32_t JOURNAL_VERSION = 1;
+
+struct JournalFileHeader {
+    char magic[4];
+    std::uint32_t version;
+};
+
+static_assert(sizeof(JournalFileHeader) == 8, "JournalFileHeader must be fixed width");
+
+/*
+ * Journal statistics
+ */
+struct JournalStats {
+    std::uint64_t records = 0;      // records appended
+    std::uint64_t bytesWritten = 0; // bytes on disk (excluding the header)
+    std::uint64_t writes = 0;       // buffers written
+    std::uint64_t syncs = 0;        // fdatasync calls made for sync()
+    std::size_t buffers = 0;        // buffers allocated (more than 2 means the writer fell behind)
+    bool failed = false;            // a write failed, later records are dropped
+};
+
+/*
+ * Journal Class
+ *
+ * Asynchronous append-only journal of book events. Records are appended into a pre-allocated
+ * buffer on the caller's thread (a copy and a bounds check). Full buffers are handed to a writer
+ * thread, which writes each one with a single large sequential write() and recycles it.
+ *
+ * The appending thread never waits on the writer: if every buffer is still queued for writing, a
+ * new buffer is allocated instead (counted in the stats). The only lock is taken once per buffer
+ * hand off.
+ *
+ * A journal is appended to by one thread at a time. Everything appended is durable (written and
+ * flushed from the page cache with fdatasync) once sync() returns or the journal is destroyed.
+ * flush() only hands records to the writer, so they may still be lost in a crash.
+ */
+class Journal {
+public:
+    explicit Journal(const std::string& path, std::size_t bufferRecords = JOURNAL_BUFFER_RECORDS)
+        : bufferRecords(bufferRecords) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open journal for writing: " + path);
+        }
+
+        JournalFileHeader header;
+        std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+        header.version = JOURNAL_VERSION;
+        if (!writeAll(&header, sizeof(header))) {
+            ::close(fd);
+            throw std::runtime_error("Cannot write journal: " + path);
+        }
+
+        // double buffered to start with: one being filled, one being written
+        active = newBuffer();
+        spare.push_back(newBuffer());
+        writer = std::thread([this] { run(); });
+    }
+
+    // writes out everything appended, then stops the writer
+    ~Journal() {
+        flush();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        queued.notify_one();
+        writer.join();
+        ::fdatasync(fd);
+        ::close(fd);
+    }
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    void append(const JournalRecord& record) {
+        if (active->size == bufferRecords) {
+            handOff();
+        }
+        active->records[active->size++] = record;
+        ++records;
+    }
+
+    /*
+    * Hand the records appended so far to the writer without waiting for them to be written.
+    */
+    void flush() {
+        if (active->size > 0) {
+            handOff();
+        }
+    }
+
+    /*
+    * Flush and wait until every record appended so far is written and synced to disk (the writer
+    * calls fdatasync once every buffer handed off before the request is written).
+    */
+    void sync() {
+        flush();
+        std::unique_lock<std::mutex> lock(mutex);
+        std::uint64_t ticket = ++syncRequests;
+        queued.notify_one();
+        written.wait(lock, [this, ticket] { return syncedRequests >= ticket; });
+    }
+
+    JournalStats getStats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        JournalStats result = stats;
+        result.records = records;
+        return result;
+    }
+
+    /*
+    * Read every record of a journal file (for replay and audit).
+    */
+    static std::vector<JournalRecord> read(const std::string& path) {
+        int readFd = ::open(path.c_str(), O_RDONLY);
+        if (readFd < 0) {
+            throw std::runtime_error("Cannot open journal: " + path);
+        }
+
+        std::vector<char> bytes;
+        char chunk[1 << 16];
+        ssize_t count;
+        while ((count = ::read(readFd, chunk, sizeof(chunk))) > 0) {
+            bytes.insert(bytes.end(), chunk, chunk + count);
+        }
+        ::close(readFd);
+
+        JournalFileHeader header;
+        if (count < 0 || bytes.size() < sizeof(header)) {
+            throw std::runtime_error("Cannot read journal: " + path);
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 || header.version != JOURNAL_VERSION) {
+            throw std::runtime_error("Invalid journal: " + path);
+        }
+
+        std::vector<JournalRecord> journalRecords((bytes.size() - sizeof(header)) / sizeof(JournalRecord));
+        std::memcpy(journalRecords.data(), bytes.data() + sizeof(header), journalRecords.size() * sizeof(JournalRecord));
+        return journalRecords;
+    }
+
+private:
+    struct Buffer {
+        std::unique_ptr<JournalRecord[]> records;
+        std::size_t size = 0;
+    };
+
+    const std::size_t bufferRecords;
+    int fd = -1;
+    std::uint64_t records = 0; // appender only
+
+    Buffer* active; // appender only
+
+    // shared with the writer (under the mutex)
+    std::mutex mutex;
+    std::condition_variable queued;
+    std::condition_variable written;
+    std::vector<std::unique_ptr<Buffer>> buffers; // owns every buffer
+    std::deque<Buffer*> full;
+    std::vector<Buffer*> spare;
+    std::uint64_t syncRequests = 0;   // sync() calls made
+    std::uint64_t syncedRequests = 0; // sync() calls whose records are durable
+    bool stopping = false;
+    JournalStats stats;
+
+    std::thread writer;
+
+    Buffer* newBuffer() {
+        buffers.push_back(std::make_unique<Buffer>());
+        buffers.back()->records = std::make_unique<JournalRecord[]>(bufferRecords);
+        stats.buffers = buffers.size();
+        return buffers.back().get();
+    }
+
+    /*
+    * Queue the active buffer for writing and carry on in a spare (or a new buffer if none is free).
+    */
+    void handOff() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            full.push_back(active);
+            if (spare.empty()) {
+                active = newBuffer();
+            } else {
+                active = spare.back();
+                spare.pop_back();
+            }
+        }
+        queued.notify_one();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            queued.wait(lock, [this] { return !full.empty() || syncRequests > syncedRequests || stopping; });
+            if (full.empty() && syncRequests > syncedRequests) {
+                // every buffer handed off before these requests is written, so one fdatasync covers them all
+                std::uint64_t ticket = syncRequests;
+                lock.unlock();
+                bool ok = ::fdatasync(fd) == 0;
+                lock.lock();
+                ++stats.syncs;
+                if (!ok) {
+                    stats.failed = true;
+                }
+                syncedRequests = ticket;
+                written.notify_all();
+                continue;
+            }
+            if (full.empty()) {
+                return; // stopping, and everything is written
+            }
+
+            Buffer* buffer = full.front();
+            full.pop_front();
+            bool failed = stats.failed;
+            lock.unlock();
+
+            // write outside the lock so the appender can keep handing off buffers
+            std::size_t bytes = buffer->size * sizeof(JournalRecord);
+            bool ok = !failed && writeAll(buffer->records.get(), bytes);
+            buffer->size = 0;
+
+            lock.lock();
+            if (ok) {
+                stats.bytesWritten += bytes;
+                ++stats.writes;
+            } else {
+                stats.failed = true;
+            }
+            spare.push_back(buffer);
+            written.notify_all();
+        }
+    }
+
+    bool writeAll(const void* data, std::size_t bytes) {
+        const char* next = static_cast<const char*>(data);
+        while (bytes > 0) {
+            ssize_t count = ::write(fd, next, bytes);
+            if (count < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            next += count;
+            bytes -= static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+};
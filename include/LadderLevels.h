@@ -0,0 +1,269 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#include <stdexcept>
+#include "OrderLevel.h"
+#include "DepthKernels.h"
+#include "Side.h"
+
+// LADDER SETTINGS
+const Price LADDER_MIN_PRICE = 0;
+const Price LADDER_MAX_PRICE = 65535;
+
+/*
+ * LadderLevels Class
+ *
+ * Level index for the Orderbook backed by a dense array of levels, one slot per tick over a fixed
+ * price band [minPrice, maxPrice] on each side. A cursor tracks the best bid/ask index, so the best
+ * level is found without a heap or a hash of the price.
+ *
+ * Levels are removed as soon as they are emptied (by a fill or a cancel), so the level counts only
+ * include live levels. The level objects live inline in the array for the lifetime of the book.
+ *
+ * The quantity of every tick is also kept in a packed array per side, ordered outwards from the
+ * best price (bids from the top of the band down, asks from the bottom up), so band liquidity and
+ * sweep cost queries run the vectorised depth kernels straight over the ticks from the cursor.
+ */
+class LadderLevels {
+public:
+    LadderLevels(Price minPrice = LADDER_MIN_PRICE, Price maxPrice = LADDER_MAX_PRICE)
+        : minPrice(minPrice) {
+        if (maxPrice < minPrice) {
+            throw std::invalid_argument("Ladder max price must not be below min price");
+        }
+        bidLevels.resize(static_cast<std::size_t>(maxPrice - minPrice) + 1);
+        askLevels.resize(bidLevels.size());
+        bidQuantities.resize(bidLevels.size());
+        askQuantities.resize(askLevels.size());
+        for (std::size_t i = 0; i < bidLevels.size(); ++i) {
+            bidLevels[i].price = minPrice + static_cast<Price>(i);
+            askLevels[i].price = bidLevels[i].price;
+        }
+        bestAsk = static_cast<int>(askLevels.size());
+    }
+
+    /*
+    * Whether a price is inside the band (only these prices can rest in the ladder).
+    */
+    bool contains(Price price) const {
+        return price >= minPrice && static_cast<std::size_t>(price - minPrice) < bidLevels.size();
+    }
+
+    /*
+    * Get the level at a price, creating it if it doesn't exist.
+    */
+    OrderLevel& getOrCreate(Side side, Price price) {
+        int index = toIndex(price);
+        auto& levels = (side == Side::Buy) ? bidLevels : askLevels;
+        OrderLevel& level = levels[index];
+
+        // an empty level becomes live, move the cursor if it is the new best
+        if (level.empty()) {
+            if (side == Side::Buy) {
+                ++numBids;
+                bestBid = std::max(bestBid, index);
+            } else {
+                ++numAsks;
+                bestAsk = std::min(bestAsk, index);
+            }
+        }
+        return level;
+    }
+
+    /*
+    * Get the best level on a side, or nullptr if the side is empty.
+    */
+    OrderLevel* best(Side side) {
+        if (side == Side::Buy) {
+            return bestBid < 0 ? nullptr : &bidLevels[bestBid];
+        }
+        return bestAsk >= static_cast<int>(askLevels.size()) ? nullptr : &askLevels[bestAsk];
+    }
+
+    /*
+    * Remove the best level on a side, called once matching has emptied it.
+    */
+    void popBest(Side side) {
+        release(side, *best(side));
+    }
+
+    /*
+    * Remove an emptied level, moving the cursor to the next live level if it was the best.
+    */
+    void release(Side side, OrderLevel& level) {
+        int index = toIndex(level.price);
+        if (side == Side::Buy) {
+            --numBids;
+            if (index == bestBid) {
+                while (bestBid >= 0 && bidLevels[bestBid].empty()) {
+                    --bestBid;
+                }
+            }
+        } else {
+            --numAsks;
+            if (index == bestAsk) {
+                while (bestAsk < static_cast<int>(askLevels.size()) && askLevels[bestAsk].empty()) {
+                    ++bestAsk;
+                }
+            }
+        }
+    }
+
+    std::size_t size(Side side) const {
+        return (side == Side::Buy) ? numBids : numAsks;
+    }
+
+    /*
+    * Called whenever a level's aggregate changes, to keep the packed tick quantities in step.
+    */
+    void update(Side side, const OrderLevel& level) {
+        int index = toIndex(level.price);
+        if (side == Side::Buy) {
+            bidQuantities[bidQuantities.size() - 1 - static_cast<std::size_t>(index)] = level.totalQuantity;
+        } else {
+            askQuantities[static_cast<std::size_t>(index)] = level.totalQuantity;
+        }
+    }
+
+    /*
+    * Total quantity resting on a side within ticks price ticks of its best price (the best included).
+    */
+    std::uint64_t bandQuantity(Side side, std::size_t ticks) {
+        std::size_t first = firstTick(side);
+        const std::vector<Quantity>& quantities = (side == Side::Buy) ? bidQuantities : askQuantities;
+        if (first >= quantities.size()) {
+            return 0;
+        }
+        return sumQuantities(quantities.data() + first, std::min(ticks, quantities.size() - first));
+    }
+
+    /*
+    * What taking quantity from a side, best price first and no further than limit, would fill and cost.
+    */
+    SweepCost sweep(Side side, Quantity quantity, Price limit) {
+        std::size_t first = firstTick(side);
+        const std::vector<Quantity>& quantities = (side == Side::Buy) ? bidQuantities : askQuantities;
+        SweepCost cost;
+        if (first >= quantities.size() || quantity == 0) {
+            return cost;
+        }
+
+        // only the ticks from the best price up to the limit are scanned
+        Price bestPrice = best(side)->price;
+        std::int64_t ticks = ((side == Side::Buy) ? static_cast<std::int64_t>(bestPrice) - limit : static_cast<std::int64_t>(limit) - bestPrice) + 1;
+        if (ticks <= 0) {
+            return cost;
+        }
+        std::size_t count = std::min<std::uint64_t>(static_cast<std::uint64_t>(ticks), quantities.size() - first);
+        SweepTotals totals = sweepQuantities(quantities.data() + first, count, quantity);
+        Price away = static_cast<Price>(totals.ticks) - 1;
+        cost.quantity = static_cast<Quantity>(totals.quantity);
+        if (side == Side::Buy) {
+            cost.notional = static_cast<std::int64_t>(bestPrice) * static_cast<std::int64_t>(totals.quantity) - static_cast<std::int64_t>(totals.weighted);
+            cost.worstPrice = bestPrice - away;
+        } else {
+            cost.notional = static_cast<std::int64_t>(bestPrice) * static_cast<std::int64_t>(totals.quantity) + static_cast<std::int64_t>(totals.weighted);
+            cost.worstPrice = bestPrice + away;
+        }
+        return cost;
+    }
+
+    /*
+    * Visit every live level on a side from best to worst price.
+    */
+    template<typename Fn>
+    void forEach(Side side, Fn fn) const {
+        if (side == Side::Buy) {
+            for (int i = bestBid; i >= 0; --i) {
+                if (!bidLevels[i].empty()) {
+                    fn(static_cast<const OrderLevel&>(bidLevels[i]));
+                }
+            }
+        } else {
+            for (int i = bestAsk; i < static_cast<int>(askLevels.size()); ++i) {
+                if (!askLevels[i].empty()) {
+                    fn(static_cast<const OrderLevel&>(askLevels[i]));
+                }
+            }
+        }
+    }
+
+    /*
+    * Visit every live level on a side priced at or better than limit (bids >= limit, asks <= limit),
+    * from best to worst price. Only the ticks between the cursor and the limit are scanned.
+    */
+    template<typename Fn>
+    void forEachWithin(Side side, Price limit, Fn fn) const {
+        if (side == Side::Buy) {
+            int last = std::max(limit - minPrice, 0);
+            for (int i = bestBid; i >= last; --i) {
+                if (!bidLevels[i].empty()) {
+                    fn(static_cast<const OrderLevel&>(bidLevels[i]));
+                }
+            }
+        } else {
+            int last = std::min(limit - minPrice, static_cast<int>(askLevels.size()) - 1);
+            for (int i = bestAsk; i <= last; ++i) {
+                if (!askLevels[i].empty()) {
+                    fn(static_cast<const OrderLevel&>(askLevels[i]));
+                }
+            }
+        }
+    }
+
+    /*
+    * Write up to maxLevels levels on a side into out, from best to worst price.
+    * Returns the number of levels written.
+    */
+    std::size_t depth(Side side, LevelInfo* out, std::size_t maxLevels) const {
+        std::size_t count = 0;
+        if (side == Side::Buy) {
+            for (int i = bestBid; i >= 0 && count < maxLevels; --i) {
+                if (!bidLevels[i].empty()) {
+                    out[count++] = bidLevels[i].getInfo();
+                }
+            }
+        } else {
+            for (int i = bestAsk; i < static_cast<int>(askLevels.size()) && count < maxLevels; ++i) {
+                if (!askLevels[i].empty()) {
+                    out[count++] = askLevels[i].getInfo();
+                }
+            }
+        }
+        return count;
+    }
+
+private:
+    Price minPrice;
+
+    // one slot per tick in the band, indexed by price - minPrice
+    std::vector<OrderLevel> bidLevels;
+    std::vector<OrderLevel> askLevels;
+
+    // per tick quantities, outwards from the best price (bids indexed by maxPrice - price)
+    std::vector<Quantity> bidQuantities;
+    std::vector<Quantity> askQuantities;
+
+    // CURSORS - index of the best bid/ask (-1 / band size when the side is empty)
+    int bestBid = -1;
+    int bestAsk = 0;
+
+    std::size_t numBids = 0;
+    std::size_t numAsks = 0;
+
+    // index of the best price in the side's tick quantities (the band size if the side is empty)
+    std::size_t firstTick(Side side) const {
+        if (side == Side::Buy) {
+            return bestBid < 0 ? bidQuantities.size() : bidQuantities.size() - 1 - static_cast<std::size_t>(bestBid);
+        }
+        return static_cast<std::size_t>(bestAsk);
+    }
+
+    int toIndex(Price price) const {
+        if (!contains(price)) {
+            throw std::out_of_range("Price is outside of the ladder price band");
+        }
+        return price - minPrice;
+    }
+};
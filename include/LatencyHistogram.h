@@ -0,0 +1,223 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// HISTOGRAM SETTINGS
+const int LATENCY_SUB_BUCKET_BITS = 5; // 32 linear sub buckets per power of two (~3% relative error)
+const std::uint64_t LATENCY_SUB_BUCKETS = 1 << LATENCY_SUB_BUCKET_BITS;
+const std::size_t LATENCY_BUCKETS = (64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS;
+
+/*
+ * Read a cheap, monotonic cycle counter (the TSC on x86, steady_clock nanoseconds elsewhere).
+ */
+inline std::uint64_t readCycleCounter() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+/*
+ * Cycles per nanosecond of the cycle counter, measured once against steady_clock.
+ */
+inline double cyclesPerNanosecond() {
+#if defined(__x86_64__) || defined(__i386__)
+    static const double rate = [] {
+        auto start = std::chrono::steady_clock::now();
+        std::uint64_t startCycles = readCycleCounter();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(10)) {
+        }
+        std::uint64_t cycles = readCycleCounter() - startCycles;
+        auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+        return static_cast<double>(cycles) / static_cast<double>(nanoseconds.count());
+    }();
+    return rate;
+#else
+    return 1.0;
+#endif
+}
+
+/*
+ * LatencyHistogram Class
+ *
+ * A log-linear (HDR-style) histogram of 64-bit values. Values below LATENCY_SUB_BUCKETS get a bucket
+ * each, and every power of two above that is split into LATENCY_SUB_BUCKETS linear buckets, so a
+ * recorded value is off by at most 1/LATENCY_SUB_BUCKETS of itself. Recording is a shift and an
+ * increment with no allocation, the buckets live inline in the histogram.
+ */
+class LatencyHistogram {
+public:
+    void record(std::uint64_t value) {
+        ++buckets[bucketIndex(value)];
+        ++count;
+        if (value > maxValue) {
+            maxValue = value;
+        }
+    }
+
+    /*
+    * Value at a percentile (0-100), reported as the highest value of its bucket (capped at the max).
+    */
+    std::uint64_t percentile(double percent) const {
+        if (count == 0) {
+            return 0;
+        }
+        std::uint64_t target = static_cast<std::uint64_t>(percent / 100.0 * static_cast<double>(count) + 0.5);
+        if (target == 0) {
+            target = 1;
+        }
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            seen += buckets[i];
+            if (seen >= target) {
+                return std::min(highestValue(i), maxValue);
+            }
+        }
+        return maxValue;
+    }
+
+    std::uint64_t getCount() const {
+        return count;
+    }
+
+    std::uint64_t getMax() const {
+        return maxValue;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (std::size_t i = 0; i < LATENCY_BUCKETS; ++i) {
+            buckets[i] += other.buckets[i];
+        }
+        count += other.count;
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+
+    void reset() {
+        buckets.fill(0);
+        count = 0;
+        maxValue = 0;
+    }
+
+private:
+    std::array<std::uint64_t, LATENCY_BUCKETS> buckets{};
+    std::uint64_t count = 0;
+    std::uint64_t maxValue = 0;
+
+    static std::size_t bucketIndex(std::uint64_t value) {
+        if (value < LATENCY_SUB_BUCKETS) {
+            return static_cast<std::size_t>(value);
+        }
+        int magnitude = 63 - __builtin_clzll(value);
+        int shift = magnitude - LATENCY_SUB_BUCKET_BITS;
+        std::uint64_t subBucket = value >> shift; // in [LATENCY_SUB_BUCKETS, 2 * LATENCY_SUB_BUCKETS)
+        return static_cast<std::size_t>((shift + 1) * LATENCY_SUB_BUCKETS + (subBucket - LATENCY_SUB_BUCKETS));
+    }
+
+    static std::uint64_t highestValue(std::size_t index) {
+        if (index < LATENCY_SUB_BUCKETS) {
+            return index;
+        }
+        int shift = static_cast<int>(index / LATENCY_SUB_BUCKETS) - 1;
+        std::uint64_t subBucket = index % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS;
+        return ((subBucket + 1) << shift) - 1;
+    }
+};
+
+/*
+ * Records the cycles between its construction and destruction into a histogram.
+ */
+class LatencyScope {
+public:
+    explicit LatencyScope(LatencyHistogram& histogram)
+        : histogram(histogram), start(readCycleCounter()) {}
+
+    ~LatencyScope() {
+        histogram.record(readCycleCounter() - start);
+    }
+
+    LatencyScope(const LatencyScope&) = delete;
+    LatencyScope& operator=(const LatencyScope&) = delete;
+
+private:
+    LatencyHistogram& histogram;
+    std::uint64_t start;
+};
+
+/*
+ * Per-operation latency (in cycles) recorded by an Orderbook built with ORDERBOOK_LATENCY.
+ * Operations are timed inclusively: an add or modify includes its matchOrders call.
+ */
+struct OrderbookLatency {
+    LatencyHistogram add;
+    LatencyHistogram cancel;
+    LatencyHistogram modify;
+    LatencyHistogram match;
+};
+
+/*
+ * Print p50/p99/p99.9/max in nanoseconds for each operation.
+ */
+inline void printLatencyReport(const OrderbookLatency& latency, const std::string& title) {
+    double rate = cyclesPerNanosecond();
+    auto nanoseconds = [rate](std::uint64_t cycles) {
+        return static_cast<std::uint64_t>(static_cast<double>(cycles) / rate);
+    };
+
+    std::cout << title << " latency (ns): operation, count, p50, p99, p99.9, max" << std::endl;
+    for (auto& entry : {std::make_pair("add", &latency.add), std::make_pair("cancel", &latency.cancel),
+                        std::make_pair("modify", &latency.modify), std::make_pair("match", &latency.match)}) {
+        const LatencyHistogram& histogram = *entry.second;
+        std::cout << "  " << entry.first << ", " << histogram.getCount() << ", "
+                  << nanoseconds(histogram.percentile(50)) << ", " << nanoseconds(histogram.percentile(99)) << ", "
+                  << nanoseconds(histogram.percentile(99.9)) << ", " << nanoseconds(histogram.getMax()) << std::endl;
+    }
+}
+
+/*
+ * Instrumentation policies
+ *
+ * The book opens a scope around each add, cancel, modify and match. NoInstrumentation hands back an
+ * empty scope, so the timing code is compiled out. LatencyInstrumentation times each operation into
+ * its histogram.
+ */
+class NoInstrumentation {
+public:
+    struct Scope {};
+
+    Scope add() { return {}; }
+    Scope cancel() { return {}; }
+    Scope modify() { return {}; }
+    Scope match() { return {}; }
+};
+
+class LatencyInstrumentation {
+public:
+    LatencyScope add() { return LatencyScope(latency.add); }
+    LatencyScope cancel() { return LatencyScope(latency.cancel); }
+    LatencyScope modify() { return LatencyScope(latency.modify); }
+    LatencyScope match() { return LatencyScope(latency.match); }
+
+    const OrderbookLatency& getLatency() const {
+        return latency;
+    }
+
+private:
+    OrderbookLatency latency;
+};
+
+// instrumentation of the default books, latency histograms only when built with ORDERBOOK_LATENCY
+#ifdef ORDERBOOK_LATENCY
+using DefaultInstrumentation = LatencyInstrumentation;
+#else
+using DefaultInstrumentation = NoInstrumentation;
+#endif
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include "Types.h"
+#include "Side.h"
+
+using Sequence = std::uint64_t;
+
+enum class LevelUpdateType : std::uint8_t {
+    Added,   // a new price level (quantity is its first order)
+    Changed, // an existing level's aggregate quantity or order count changed
+    Deleted  // the level is gone (quantity and order count are 0)
+};
+
+/*
+ * An incremental L2 update: the new aggregate of one price level, stamped with the book's sequence
+ * number. Sequence numbers go up by one per update, so a consumer can spot a gap.
+ */
+struct LevelUpdate {
+    Sequence sequence;
+    Side side;
+    LevelUpdateType type;
+    Price price;
+    Quantity quantity;
+    std::uint32_t orderCount;
+};
+
+using LevelUpdates = std::vector<LevelUpdate>;
+
+/*
+ * Full L2 depth of the book (live levels only, best price first) as of a sequence number.
+ * Updates after the snapshot are those with a greater sequence number.
+ */
+struct LevelSnapshot {
+    Sequence sequence;
+    LevelInfos bids;
+    LevelInfos asks;
+};
+
+/*
+ * MirrorBook Class
+ *
+ * Keeps an L2 copy of a book from a snapshot and the level updates published after it.
+ * Throws std::runtime_error if an update arrives out of sequence.
+ */
+class MirrorBook {
+public:
+    void load(const LevelSnapshot& snapshot) {
+        bids.clear();
+        asks.clear();
+        for (const LevelInfo& level : snapshot.bids) {
+            bids[level.price] = level;
+        }
+        for (const LevelInfo& level : snapshot.asks) {
+            asks[level.price] = level;
+        }
+        sequence = snapshot.sequence;
+    }
+
+    void apply(const LevelUpdate& update) {
+        if (update.sequence <= sequence) {
+            return; // already in the snapshot
+        }
+        if (update.sequence != sequence + 1) {
+            throw std::runtime_error("Level update sequence gap");
+        }
+        sequence = update.sequence;
+
+        if (update.side == Side::Buy) {
+            apply(bids, update);
+        } else {
+            apply(asks, update);
+        }
+    }
+
+    // live levels on a side from best to worst price
+    LevelInfos getLevels(Side side) const {
+        LevelInfos levels;
+        if (side == Side::Buy) {
+            for (const auto& level : bids) {
+                levels.push_back(level.second);
+            }
+        } else {
+            for (const auto& level : asks) {
+                levels.push_back(level.second);
+            }
+        }
+        return levels;
+    }
+
+    Sequence getSequence() const {
+        return sequence;
+    }
+
+private:
+    std::map<Price, LevelInfo, std::greater<Price>> bids;
+    std::map<Price, LevelInfo> asks;
+    Sequence sequence = 0;
+
+    template<typename Levels>
+    static void apply(Levels& levels, const LevelUpdate& update) {
+        if (update.type == LevelUpdateType::Deleted) {
+            levels.erase(update.price);
+        } else {
+            levels[update.price] = LevelInfo{update.price, update.quantity, update.orderCount};
+        }
+    }
+};
@@ -3,41 +3,50 @@
 #include <vector>
 #include <stack>
 #include <stdexcept>
+#include "PoolStats.h"
 
 /*
  * MemoryPool Class
  * 
  * A templated memory pool class for preallocating and managing objects. This helps in optimizing 
  * memory allocation and ensuring memory safety by reducing the frequency of allocations and deallocations.
+ *
+ * Each object is a separate heap allocation, kept on a free stack while it is not in use. The pool
+ * owns every object it created, so objects still allocated when it is destroyed are freed too.
+ * It has the same interface as SlabPool, so either can be the Orderbook's allocator.
  */
 template<typename T>
 class MemoryPool {
 public:
     // constructor to preallocate memory for a given number of objects
     MemoryPool(size_t preallocateSize = 1000) {
-        for (size_t i = 0; i < preallocateSize; ++i) {
-            pool.push(new T());
-        }
+        reserve(preallocateSize);
     }
 
     // destructor to clean up allocated memory
     ~MemoryPool() {
-        while (!pool.empty()) {
-            delete pool.top();
-            pool.pop();
+        for (T* obj : objects) {
+            delete obj;
         }
     }
 
+    MemoryPool(const MemoryPool&) = delete;
+    MemoryPool& operator=(const MemoryPool&) = delete;
+
     /*
     * Allocate an object from the pool. If no objects are available in the pool, create a new one.
     */
     T* allocate() {
         if (pool.empty()) {
             // If no available objects in pool, create a new one
-            return new T();
+            ++stats.misses;
+            create();
         }
         T* obj = pool.top();
         pool.pop();
+        if (++stats.inUse > stats.highWaterMark) {
+            stats.highWaterMark = stats.inUse;
+        }
         return obj;
     }
 
@@ -47,9 +56,31 @@ public:
     void deallocate(T* obj) {
         if (obj != nullptr) {
             pool.push(obj);
+            --stats.inUse;
+        }
+    }
+
+    /*
+    * Create objects until the pool can hold at least capacity objects.
+    */
+    void reserve(size_t capacity) {
+        while (stats.capacity < capacity) {
+            create();
         }
     }
 
+    const PoolStats& getStats() const {
+        return stats;
+    }
+
 private:
-    std::stack<T*> pool; // Stack to manage the preallocated objects
+    std::stack<T*> pool;     // Stack to manage the preallocated objects
+    std::vector<T*> objects; // every object created, freed with the pool
+    PoolStats stats;
+
+    void create() {
+        objects.push_back(new T());
+        pool.push(objects.back());
+        ++stats.capacity;
+    }
 };
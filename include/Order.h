@@ -7,27 +7,29 @@
 #include <stdexcept>
 #include <list>
 
+struct OrderLevel;
+
 class Order {
 public:
-    Order(OrderId orderId, Price price, Quantity quantity, Side side, OrderType orderType) {
+    Order(OrderId orderId, Price price, Quantity quantity, Side side, OrderType orderType, Time time = 0) {
         this->orderId = orderId;
         this->price = price;
         this->initialQuantity = quantity;
         this->remainingQuantity = quantity;
         this->side = side;
         this->orderType = orderType;
-        this->time = std::chrono::system_clock::now();
+        this->time = time;
     }
 
     // default constructor for memory pool
     Order() {
-        this->orderId = -1;
+        this->orderId = INVALID_ORDER_ID;
         this->price = 0;
         this->initialQuantity = 0;
         this->remainingQuantity = 0;
         this->side = Side::Buy;
         this->orderType = OrderType::LimitOrder;
-        this->time = std::chrono::system_clock::now();
+        this->time = 0;
     }
 
     OrderId getOrderId() {
@@ -66,7 +68,23 @@ public:
         remainingQuantity -= quantity;
     }
 
+    // amend the order down, the quantity already filled stays the same
+    void reduce(Quantity quantity) {
+        if (quantity > remainingQuantity) {
+            throw std::runtime_error("Cannot reduce by more than remaining quantity");
+        }
+        initialQuantity -= quantity;
+        remainingQuantity -= quantity;
+    }
+
+    // price level the order is resting in (nullptr if not resting)
+    OrderLevel* getLevel() {
+        return level;
+    }
+
 private:
+    friend struct OrderLevel;
+
     OrderId orderId;
     Price price;
     Side side;
@@ -74,6 +92,11 @@ private:
     Quantity initialQuantity;
     Quantity remainingQuantity;
     Time time;
+
+    // INTRUSIVE LINKS - neighbours in the level queue, and the level itself
+    Order* prev = nullptr;
+    Order* next = nullptr;
+    OrderLevel* level = nullptr;
 };
 
 using OrderPtr = Order*;
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include "Types.h"
+#include "Side.h"
+#include "OrderType.h"
+#include "Trade.h"
+
+/*
+ * Binary order event format
+ *
+ * A file is an OrderEventFileHeader followed by a packed array of fixed-width OrderEvents
+ * (native byte order), so it can be memory mapped and read in place.
+ */
+enum class OrderEventType : std::uint8_t {
+    Add,
+    Cancel,
+    Modify
+};
+
+struct OrderEvent {
+    OrderEventType eventType;
+    Side side;
+    OrderType orderType;
+    std::uint8_t reserved;
+    Price price;          // price in ticks
+    Quantity quantity;
+    std::uint32_t padding;
+    OrderId orderId;      // order to cancel/modify (unused for adds)
+};
+
+static_assert(sizeof(OrderEvent) == 24, "OrderEvent must be fixed width");
+
+const char ORDER_EVENT_MAGIC[4] = {'O', 'B', 'E', 'V'};
+const std::uint32_t ORDER_EVENT_VERSION = 1;
+
+struct OrderEventFileHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint64_t count; // number of events following the header
+};
+
+static_assert(sizeof(OrderEventFileHeader) == 16, "OrderEventFileHeader must be fixed width");
+
+/*
+ * Apply an order event to a book, appending any trades to the buffer.
+ * Returns the id of the new order (INVALID_ORDER_ID for cancels and rejected orders).
+ */
+template<typename Book>
+OrderId applyOrderEvent(Book& orderbook, const OrderEvent& event, Trades& trades) {
+    switch (event.eventType) {
+        case OrderEventType::Add:
+            return orderbook.addOrder(event.price, event.quantity, event.side, event.orderType, trades);
+        case OrderEventType::Cancel:
+            orderbook.cancelOrder(event.orderId);
+            return INVALID_ORDER_ID;
+        case OrderEventType::Modify:
+            return orderbook.modifyOrder(event.orderId, event.price, event.quantity, event.side, trades);
+    }
+    return INVALID_ORDER_ID;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "OrderEvent.h"
+
+/*
+ * OrderEventFile Class
+ *
+ * Read-only view of a binary order event file. The file is memory mapped, and the events are read
+ * in place (no copies). The mapping is released when the object is destroyed.
+ */
+class OrderEventFile {
+public:
+    explicit OrderEventFile(const std::string& path);
+    ~OrderEventFile();
+
+    OrderEventFile(const OrderEventFile&) = delete;
+    OrderEventFile& operator=(const OrderEventFile&) = delete;
+
+    const OrderEvent* begin() const;
+    const OrderEvent* end() const;
+    std::size_t size() const;
+
+    /*
+    * Write events to a binary order event file.
+    */
+    static void write(const std::string& path, const std::vector<OrderEvent>& events);
+
+    /*
+    * Parse a line of the text order format (one "side price quantity" line per order, as written by
+    * python/order_generator.py, side 1 is a buy) into a limit order add event. Returns false if the
+    * line isn't an order.
+    */
+    static bool parseTextLine(const std::string& line, OrderEvent& event);
+
+    /*
+    * Read a text order file into add events (lines that aren't orders are reported and skipped).
+    */
+    static std::vector<OrderEvent> readText(const std::string& path);
+
+private:
+    void* mapping = nullptr;
+    std::size_t mappingSize = 0;
+    const OrderEvent* events = nullptr;
+    std::size_t count = 0;
+};
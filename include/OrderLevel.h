@@ -2,28 +2,127 @@
 
 #include "Types.h"
 #include "Order.h"
-#include <queue>
 #include <vector>
 #include <memory>
 
-// bid/ask types
-using Queue = std::deque<OrderPtr>;
-using QueuePtr = std::shared_ptr<Queue>;
+/*
+ * A single price level: the resting orders at one price, in time priority.
+ *
+ * The queue is an intrusive doubly linked list through the orders themselves, and each order keeps
+ * a back-pointer to its level, so an order can be unlinked in O(1) without searching the level.
+ *
+ * The total remaining quantity and the number of orders are kept up to date as orders are added,
+ * filled and removed, so reading a level never walks its orders.
+ */
+struct OrderLevel {
+    Price price = 0;
+    Quantity totalQuantity = 0;
+    std::uint32_t orderCount = 0;
+
+    // forward iterator over the orders in time priority
+    class Iterator {
+    public:
+        explicit Iterator(Order* order) : order(order) {}
+        Order* operator*() const { return order; }
+        Iterator& operator++() { order = order->next; return *this; }
+        bool operator!=(const Iterator& other) const { return order != other.order; }
+    private:
+        Order* order;
+    };
+
+    bool empty() const {
+        return head == nullptr;
+    }
+
+    OrderPtr front() const {
+        return head;
+    }
+
+    /*
+    * Append an order to the back of the level (lowest time priority).
+    */
+    void push_back(OrderPtr order) {
+        totalQuantity += order->getRemainingQuantity();
+        ++orderCount;
+        order->level = this;
+        order->prev = tail;
+        order->next = nullptr;
+        if (tail != nullptr) {
+            tail->next = order;
+        } else {
+            head = order;
+        }
+        tail = order;
+    }
+
+    /*
+    * Remove the order at the front of the level.
+    */
+    void pop_front() {
+        erase(head);
+    }
+
+    /*
+    * Unlink an order resting in this level.
+    */
+    void erase(OrderPtr order) {
+        totalQuantity -= order->getRemainingQuantity();
+        --orderCount;
+        if (order->prev != nullptr) {
+            order->prev->next = order->next;
+        } else {
+            head = order->next;
+        }
+        if (order->next != nullptr) {
+            order->next->prev = order->prev;
+        } else {
+            tail = order->prev;
+        }
+        order->prev = nullptr;
+        order->next = nullptr;
+        order->level = nullptr;
+    }
 
+    /*
+    * Fill an order resting in this level.
+    */
+    void fill(OrderPtr order, Quantity quantity) {
+        order->fill(quantity);
+        totalQuantity -= quantity;
+    }
+
+    /*
+    * Reduce the quantity of an order resting in this level without changing its place in the queue.
+    */
+    void reduce(OrderPtr order, Quantity quantity) {
+        order->reduce(quantity);
+        totalQuantity -= quantity;
+    }
+
+    LevelInfo getInfo() const {
+        return LevelInfo{price, totalQuantity, orderCount};
+    }
+
+    Iterator begin() const { return Iterator(head); }
+    Iterator end() const { return Iterator(nullptr); }
+
+private:
+    OrderPtr head = nullptr;
+    OrderPtr tail = nullptr;
+};
+
+using OrderLevelPtr = std::shared_ptr<OrderLevel>;
+
+// bid/ask types
 struct BidComparator {
-    bool operator()(const std::pair<Price, QueuePtr>& lhs,
-                    const std::pair<Price, QueuePtr>& rhs) const {
-        return lhs.first < rhs.first; 
+    bool operator()(const OrderLevelPtr& lhs, const OrderLevelPtr& rhs) const {
+        return lhs->price < rhs->price; 
     }
 };
 
 struct AskComparator {
-    bool operator()(const std::pair<Price, QueuePtr>& lhs,
-                    const std::pair<Price, QueuePtr>& rhs) const {
-        return lhs.first > rhs.first;
+    bool operator()(const OrderLevelPtr& lhs, const OrderLevelPtr& rhs) const {
+        return lhs->price > rhs->price;
     }
 };
 
-
-using Bids = std::priority_queue<std::pair<double, QueuePtr>, std::vector<std::pair<double, QueuePtr>>, BidComparator>;
-using Asks = std::priority_queue<std::pair<double, QueuePtr>, std::vector<std::pair<double, QueuePtr>>, AskComparator>;
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "OrderEvent.h"
+#include "SpscRing.h"
+#include "ThreadAffinity.h"
+
+// PIPELINE SETTINGS
+const std::size_t PIPELINE_BATCH_SIZE = 256;
+
+// order command sent from the gateway to the matching thread
+struct OrderCommand {
+    std::uint64_t sequence;
+    std::int64_t submitNanos; // gateway timestamp, echoed back in the reports
+    OrderEvent event;
+};
+
+enum class ReportType : std::uint8_t {
+    Trade,
+    Confirmation // last report for a command
+};
+
+// report sent from the matching thread back to the gateway
+struct ExecutionReport {
+    ReportType reportType;
+    std::uint64_t sequence;
+    std::int64_t submitNanos;
+    OrderId orderId;   // confirmation: new order id (INVALID_ORDER_ID for cancels/rejects)
+    TradeInfo bidTrade; // trade only
+    TradeInfo askTrade; // trade only
+};
+
+/*
+ * OrderPipeline Class
+ *
+ * Splits order ingest from matching. The gateway thread (the owner of the pipeline) pushes
+ * OrderCommands into a lock-free SPSC ring. A matching thread drains that ring in batches into the
+ * book and pushes the trades and a confirmation for each command back on a second SPSC ring, which
+ * the gateway polls. Matching never waits on parsing or I/O done by the gateway.
+ *
+ * The book must not be touched by other threads while the pipeline is running.
+ */
+template<typename Book>
+class OrderPipeline {
+public:
+    OrderPipeline(Book& orderbook, std::size_t capacity = 1 << 16, bool pinThreads = true)
+        : orderbook(orderbook), commands(capacity), reports(capacity) {
+        matcher = std::thread([this] { run(); });
+        if (pinThreads) {
+            pinThreadToCore(matcher, 1);
+        }
+    }
+
+    // stops the matching thread once the queued commands have been matched
+    ~OrderPipeline() {
+        running.store(false, std::memory_order_release);
+        // keep draining reports so the matcher can't block on a full report ring
+        ExecutionReport discarded[PIPELINE_BATCH_SIZE];
+        while (!stopped.load(std::memory_order_acquire)) {
+            reports.popBatch(discarded, PIPELINE_BATCH_SIZE);
+            std::this_thread::yield();
+        }
+        matcher.join();
+    }
+
+    OrderPipeline(const OrderPipeline&) = delete;
+    OrderPipeline& operator=(const OrderPipeline&) = delete;
+
+    /*
+    * Queue a command for matching (gateway only). Returns false if the command ring is full, in
+    * which case the gateway should poll reports before trying again.
+    */
+    bool trySubmit(const OrderCommand& command) {
+        return commands.tryPush(command);
+    }
+
+    /*
+    * Take up to maxReports reports from the matching thread (gateway only).
+    */
+    std::size_t poll(ExecutionReport* out, std::size_t maxReports) {
+        return reports.popBatch(out, maxReports);
+    }
+
+private:
+    Book& orderbook;
+    SpscRing<OrderCommand> commands;
+    SpscRing<ExecutionReport> reports;
+    std::atomic<bool> running{true};
+    std::atomic<bool> stopped{false};
+    std::thread matcher;
+
+    void publish(const ExecutionReport& report) {
+        while (!reports.tryPush(report)) {
+            std::this_thread::yield();
+        }
+    }
+
+    /*
+    * Matching loop: drain commands in batches, apply them, and report the results.
+    */
+    void run() {
+        std::vector<OrderCommand> batch(PIPELINE_BATCH_SIZE);
+        Trades trades;
+
+        while (true) {
+            std::size_t count = commands.popBatch(batch.data(), batch.size());
+            if (count == 0) {
+                if (!running.load(std::memory_order_acquire) && commands.empty()) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (std::size_t i = 0; i < count; ++i) {
+                const OrderCommand& command = batch[i];
+                trades.clear();
+                OrderId orderId = applyOrderEvent(orderbook, command.event, trades);
+
+                for (auto& trade : trades) {
+                    publish(ExecutionReport{ReportType::Trade, command.sequence, command.submitNanos, orderId, trade.getBidTrade(), trade.getAskTrade()});
+                }
+                publish(ExecutionReport{ReportType::Confirmation, command.sequence, command.submitNanos, orderId, TradeInfo{}, TradeInfo{}});
+            }
+        }
+        stopped.store(true, std::memory_order_release);
+    }
+};
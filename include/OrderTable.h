@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Order.h"
+
+// ORDER TABLE SETTINGS
+const std::size_t ORDER_TABLE_PAGE_BITS = 12; // 4096 ids (32KB of slots) per page
+
+/*
+ * OrderTable Class
+ *
+ * Map from order id to order ptr, direct-indexed by id. The book hands out ids densely in increasing
+ * order, so ids are split into a page number (the high bits) and a slot in that page (the low bits):
+ * a lookup is a bounds check and two loads, with no hashing and no per-order allocation.
+ *
+ * Pages hold only null slots until they are used, and every unused page number points at one shared
+ * empty page, so a lookup never checks for a missing page. A page is freed again once every order
+ * in it is gone and ids have moved on to a later page (the freed page is kept to be reused by the
+ * next new page), so memory follows the live orders rather than every id ever handed out. The
+ * directory of pages costs a pointer per page of ids ever used.
+ */
+class OrderTable {
+    struct Page;
+
+public:
+    /*
+    * An id resolved to its place in the table: the order in it (nullptr if none), and where it is
+    * kept so it can be erased without looking the id up again.
+    */
+    class Slot {
+    public:
+        OrderPtr get() const {
+            return *slot;
+        }
+
+    private:
+        friend class OrderTable;
+        Page* page;
+        OrderPtr* slot;
+        std::uint64_t pageIndex;
+    };
+
+    OrderTable() = default;
+
+    ~OrderTable() {
+        for (Page* page : directory) {
+            if (page != emptyPage()) {
+                delete page;
+            }
+        }
+        delete sparePage;
+    }
+
+    OrderTable(const OrderTable&) = delete;
+    OrderTable& operator=(const OrderTable&) = delete;
+
+    /*
+    * Get the order with an id, or nullptr if there is none.
+    */
+    OrderPtr find(OrderId orderId) const {
+        std::uint64_t id = static_cast<std::uint64_t>(orderId);
+        std::uint64_t pageIndex = id >> ORDER_TABLE_PAGE_BITS;
+        if (pageIndex >= directory.size()) {
+            return nullptr;
+        }
+        return directory[pageIndex]->slots[id & SLOT_MASK];
+    }
+
+    /*
+    * Resolve an id to its slot, to read the order and then erase it with a single lookup.
+    */
+    Slot findSlot(OrderId orderId) const {
+        std::uint64_t id = static_cast<std::uint64_t>(orderId);
+        std::uint64_t pageIndex = id >> ORDER_TABLE_PAGE_BITS;
+        Slot slot;
+        slot.pageIndex = pageIndex;
+        slot.page = pageIndex < directory.size() ? directory[pageIndex] : emptyPage();
+        slot.slot = &slot.page->slots[pageIndex < directory.size() ? (id & SLOT_MASK) : 0];
+        return slot;
+    }
+
+    /*
+    * Add an order under its id (which must not already be in the table).
+    */
+    void insert(OrderPtr order) {
+        std::uint64_t id = static_cast<std::uint64_t>(order->getOrderId());
+        std::uint64_t pageIndex = id >> ORDER_TABLE_PAGE_BITS;
+        if (pageIndex >= directory.size()) {
+            directory.resize(pageIndex + 1, emptyPage());
+        }
+        if (pageIndex > lastPage) {
+            // ids have moved on, so an emptied last page won't be used again
+            std::uint64_t previousPage = lastPage;
+            lastPage = pageIndex;
+            if (directory[previousPage] != emptyPage() && directory[previousPage]->live == 0) {
+                releasePage(previousPage);
+            }
+        }
+
+        Page* page = directory[pageIndex];
+        if (page == emptyPage()) {
+            page = newPage();
+            directory[pageIndex] = page;
+        }
+        page->slots[id & SLOT_MASK] = order;
+        ++page->live;
+        ++count;
+    }
+
+    /*
+    * Remove an order and return it, or nullptr if there is no order with that id.
+    */
+    OrderPtr take(OrderId orderId) {
+        Slot slot = findSlot(orderId);
+        OrderPtr order = slot.get();
+        if (order != nullptr) {
+            erase(slot);
+        }
+        return order;
+    }
+
+    /*
+    * Remove the order in a slot from findSlot (the slot must hold an order, and the table must not
+    * have been changed since it was found).
+    */
+    void erase(const Slot& slot) {
+        *slot.slot = nullptr;
+        --count;
+        if (--slot.page->live == 0 && slot.pageIndex != lastPage) {
+            releasePage(slot.pageIndex);
+        }
+    }
+
+    /*
+    * Remove an order (no-op if there is no order with that id).
+    */
+    void erase(OrderId orderId) {
+        take(orderId);
+    }
+
+    std::size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    /*
+    * Number of pages allocated (in use, plus the spare page).
+    */
+    std::size_t getNumPages() const {
+        return pages + (sparePage != nullptr ? 1 : 0);
+    }
+
+private:
+    static constexpr std::uint64_t SLOT_MASK = (std::uint64_t(1) << ORDER_TABLE_PAGE_BITS) - 1;
+
+    struct Page {
+        OrderPtr slots[std::size_t(1) << ORDER_TABLE_PAGE_BITS] = {};
+        std::size_t live = 0;
+    };
+
+    // page number to page (emptyPage() when the page has no orders)
+    std::vector<Page*> directory;
+    // an emptied page kept for the next new page
+    Page* sparePage = nullptr;
+    // the page of the highest id inserted so far (new ids land here or later)
+    std::uint64_t lastPage = 0;
+    std::size_t pages = 0;
+    std::size_t count = 0;
+
+    // shared page of null slots (never written)
+    static Page* emptyPage() {
+        static Page page;
+        return &page;
+    }
+
+    Page* newPage() {
+        ++pages;
+        if (sparePage != nullptr) {
+            Page* page = sparePage;
+            sparePage = nullptr;
+            return page;
+        }
+        return new Page();
+    }
+
+    // every slot of an emptied page is already null, so it can be reused as it is
+    void releasePage(std::uint64_t pageIndex) {
+        Page* page = directory[pageIndex];
+        directory[pageIndex] = emptyPage();
+        --pages;
+        if (sparePage == nullptr) {
+            sparePage = page;
+        } else {
+            delete page;
+        }
+    }
+};
@@ -1,6 +1,15 @@
 #pragma once
 
-enum class OrderType {
+#include <cstdint>
+
+enum class OrderType : std::uint8_t {
     LimitOrder,
-    MarketOrder
-};
\ No newline at end of file
+    MarketOrder,
+    ImmediateOrCancel, // fills what it can at its limit price straight away, the rest is cancelled
+    FillOrKill         // fills in full at its limit price straight away, or not at all
+};
+
+// immediate orders are matched straight off the opposite side and never rest in the book
+inline bool isImmediate(OrderType orderType) {
+    return orderType == OrderType::ImmediateOrCancel || orderType == OrderType::FillOrKill;
+}
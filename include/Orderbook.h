@@ -4,19 +4,57 @@
 #include <queue>
 #include <functional>
 #include <numeric>
+#include <limits>
+#include <optional>
 #include "Order.h"
 #include "OrderLevel.h"
+#include "HeapLevels.h"
+#include "LadderLevels.h"
+#include "TreeLevels.h"
 #include "Trade.h"
 #include "OrderbookLevelInfos.h"
-#include "MemoryPool.h" 
+#include "SlabPool.h"
+#include "MemoryPool.h"
+#include "LatencyHistogram.h"
+#include "MarketData.h"
+#include "Journal.h"
+#include "BookSnapshot.h"
+#include "TimeSource.h"
+#include "TradeSink.h"
+#include "StopBook.h"
+#include "OrderTable.h"
 
 /*
-* Orderbook class
+ * A single order in a batch submitted to addOrderBatch
+ */
+struct OrderRequest {
+    Price price;
+    Quantity quantity;
+    Side side;
+    OrderType orderType;
+};
+
+/*
+* BasicOrderbook class
 
 * Architecture:
-* - Orders are stored in a map from order id to order ptr
-* - Bids and Asks are stored in a max heap and min heap respectively
-* - Price levels are a queue of orders in each entry of the heaps
+* - Orders live in a pool (the Allocator policy) and are found by id through an OrderTable (paged
+*   slots indexed directly by the order id):
+*   - SlabPool<Order> (default): contiguous chunks with an intrusive free list
+*   - MemoryPool<Order>: one heap allocation per order, kept on a free stack
+* - Price levels are a queue of orders, indexed by the Levels policy:
+*   - HeapLevels: bids and asks in a max heap and min heap, with a price to level map (lazy deletion)
+*   - LadderLevels: dense array of levels over a tick band, with a best bid/ask cursor
+*   - TreeLevels: an ordered map of levels per side (any price, always in price order)
+* - Orders are timestamped by the Clock policy (see TimeSource.h): SequenceClock (the default, logical
+*   time), TscClock (cycle counter) or SimulationClock (time set by the caller through getClock())
+* - Every trade is also handed to the TradeSink policy (see TradeSink.h), NoTradeSink by default
+* - add/cancel/modify/match are timed by the Instrumentation policy: NoInstrumentation, or
+*   LatencyInstrumentation (the default when built with ORDERBOOK_LATENCY)
+*
+* Policies are template parameters, so every combination is a fully specialised engine with no
+* virtual calls and no runtime checks for the policies it doesn't use. The specialisations built
+* are listed at the bottom of Orderbook.cpp.
 *
 * The Orderbook class is responsible for:
 * - Adding orders to the orderbook
@@ -25,44 +63,170 @@
 * - Matching orders in the orderbook
 * - Returning the number of bids, asks, and orders in the orderbook
 * - Returning the orderbook level information
+* - Returning the top N levels of a side (from the per-level aggregates, no allocation)
+* - Returning the best bid/ask, spread and mid price in O(1)
+* - Returning the quantity resting within N ticks of the touch (getBandQuantity) and what sweeping
+*   Q from a side would fill and cost (getSweepCost). Both take the side being queried: a buy of Q
+*   sweeps the asks. The ladder runs these over packed per-tick quantities with the vectorised
+*   kernels in DepthKernels.h, the other level indexes walk their levels.
 *
 * - Supports Market Orders orders
 * - Supports Limit Orders
+* - Supports Immediate-or-Cancel and Fill-or-Kill orders: these are matched straight off the opposite
+*   side without allocating an order, and the unfilled remainder never touches the pool or the
+*   levels. A Fill-or-Kill is checked against the opposite side's level aggregates (getSweepCost)
+*   before any fill. Either is rejected (INVALID_ORDER_ID) if nothing fills
+*
+* An order that would rest at a price the level index can't hold (outside a LadderLevels band) is
+* refused with std::out_of_range before anything happens: no order id, journal record or pool slot
+* is used, and a batch is checked whole before any of it is inserted (including its market and
+* immediate-or-cancel requests, which rest at their price until the uncross).
+*
+* addOrder/modifyOrder can also append their trades to a caller-owned Trades buffer and return the
+* order id (INVALID_ORDER_ID if the order was rejected). Reusing the buffer means an add that doesn't
+* fill allocates no trade storage.
+*
+* addOrderBatch runs a call auction: the whole batch is inserted without matching, a single clearing
+* price is picked from the crossed levels (maximum executable volume, then minimum imbalance, then the
+* middle of the tied prices) and the book is uncrossed once, with every trade printed at that price.
+* Market and Immediate-or-Cancel orders in a batch take part at their price, and any unfilled
+* remainder is cancelled. Fill-or-Kill orders are rejected in a batch.
+*
+* Stop orders: addStopOrder/addStopLimitOrder park an order in a trigger index (StopBook) keyed by
+* trigger price, instead of the book. After each add, modify or batch, only the trigger buckets
+* crossed by the range of prices traded are visited, so the cost is in the stops triggered, not the
+* stops resting. A triggered stop is injected under a new order id: a stop as an Immediate-or-Cancel
+* with no price limit, a stop-limit as a Limit order at its limit. Stops triggered together are
+* injected buy stops first (lowest trigger first), then sell stops (highest trigger first), first
+* placed first within a price, and the trades they make can trigger further stops (cascades) in the
+* same call. A stop whose trigger the last trade has already reached fires as soon as it is added.
+* Pending stops are not part of snapshots.
+*
+* Level updates: once setLevelUpdates is given a buffer, every change to a price level appends an
+* L2 update (added/changed/deleted with the new aggregate) and a sequence number. Fills are
+* coalesced, so a level touched by several fills in one match gets one update. getLevelSnapshot
+* returns the full depth as of the current sequence, to start or resync a mirror book.
+*
+* Journal: once setJournal is given a journal, every add, cancel, modify, reject and trade is appended
+* to it as a binary record in the order the book handled them. The journal's writer thread does the
+* disk I/O, so matching never waits on a write.
+*
+* Snapshots: saveSnapshot writes every resting order (in priority order), the next order id and the
+* pool size to a binary file. loadSnapshot rebuilds an empty book from it in one pass without
+* matching, so a simulation can restart from a checkpoint instead of replaying every order. A
+* snapshot from one engine can be loaded into another. Loading into a ladder whose band doesn't
+* cover every price in the snapshot throws std::out_of_range before any order is inserted.
+*
+* modifyOrder amends in place when the price and side are unchanged and the quantity doesn't go up:
+* the order keeps its id and time priority and no matching runs. Any other modify requeues the order
+* (cancel and add) under a new id at the back of its new level.
+*
+* With LatencyInstrumentation (make LATENCY=1 for the default books), add/cancel/modify/match record
+* their latency in cycles into histograms returned by getInstrumentation().getLatency(). With
+* NoInstrumentation the timing code is compiled out entirely.
 */
-class Orderbook {
+template<typename Levels, typename Clock = SequenceClock, typename Allocator = SlabPool<Order>,
+         typename TradeSink = NoTradeSink, typename Instrumentation = DefaultInstrumentation>
+class BasicOrderbook {
 public:
-    Orderbook();
+    BasicOrderbook(Levels levels = Levels());
     void printOrderbook();
     OrderConfirmation addOrder(const Price price, const Quantity quantity, const Side side, const OrderType orderType);
+    OrderId addOrder(const Price price, const Quantity quantity, const Side side, const OrderType orderType, Trades& trades);
     void cancelOrder(OrderId orderId);
     OrderConfirmation modifyOrder(OrderId orderId, Price price, Quantity quantity, Side side);
+    OrderId modifyOrder(OrderId orderId, Price price, Quantity quantity, Side side, Trades& trades);
+    std::optional<Price> addOrderBatch(const OrderRequest* requests, std::size_t count, OrderId* orderIds, Trades& trades);
     std::size_t getNumBids() const;
     std::size_t getNumAsks() const;
     std::size_t getNumOrders() const;
     OrderBookLevelInfos getOrderInfos() const;
+    std::size_t getDepth(Side side, LevelInfo* levelInfos, std::size_t maxLevels) const;
+    std::uint64_t getBandQuantity(Side side, std::size_t ticks);
+    SweepCost getSweepCost(Side side, Quantity quantity);
+    std::optional<Price> getBestBid();
+    std::optional<Price> getBestAsk();
+    std::optional<Price> getSpread();
+    std::optional<double> getMidPrice();
+    const PoolStats& getPoolStats() const;
+    void saveSnapshot(const std::string& path) const;
+    void loadSnapshot(const std::string& path);
+    void setJournal(Journal* journal);
+    void setLevelUpdates(LevelUpdates* levelUpdates);
+    LevelSnapshot getLevelSnapshot() const;
+    Clock& getClock();
+    std::optional<Time> getOrderTime(OrderId orderId) const;
+    TradeSink& getTradeSink();
+    const Instrumentation& getInstrumentation() const;
+    StopId addStopOrder(Price triggerPrice, Quantity quantity, Side side, Trades& trades);
+    StopId addStopLimitOrder(Price triggerPrice, Price limitPrice, Quantity quantity, Side side, Trades& trades);
+    bool cancelStopOrder(StopId stopId);
+    std::size_t getNumStops() const;
+    void setStopTriggers(StopTriggers* stopTriggers);
 
 private:
     OrderId orderId = 0;
 
-    MemoryPool<Order> orderPool; // Memory pool to manage Order objects
+    Allocator orderPool; // pool to manage Order objects
+
+    // price levels on both sides of the book
+    Levels levels;
+
+    // time source for order timestamps
+    Clock clock;
+
+    // receives every trade as it is made
+    TradeSink tradeSink;
+
+    // times add/cancel/modify/match
+    Instrumentation instrumentation;
+
+    // order id to order ptr
+    OrderTable orders;
+
+    // caller-owned journal (nullptr when journaling is off)
+    Journal* journal = nullptr;
+
+    // caller-owned buffer for level updates (nullptr when nobody is listening)
+    LevelUpdates* levelUpdates = nullptr;
+    Sequence sequence = 0;
+
+    // crossed levels gathered for an auction (kept to reuse their storage)
+    LevelInfos auctionBids;
+    LevelInfos auctionAsks;
 
-    // HEAPS - Allow for quick access to the best bid/ask
-    // max heap based on price, then min heap based on time
-    Bids bids;
-    // min heap based on price, then min heap based on time
-    Asks asks;
+    // pending stops, and the ones triggered but not yet injected
+    StopBook stops;
+    std::deque<StopOrder> triggeredStops;
+    StopId stopId = 0;
 
-    // MAPS - Allow for quick access to the level (add, remove, modify orders)
-    // map from price to level
-    std::unordered_map<Price, QueuePtr> askLevels;
-    // map from price to level
-    std::unordered_map<Price, QueuePtr> bidLevels;
+    // caller-owned buffer for triggered stops (nullptr when nobody is listening)
+    StopTriggers* stopTriggers = nullptr;
 
-    // map of order id to order ptr
-    std::unordered_map<OrderId, OrderPtr> orders;
+    // last trade price, and the range traded since stops were last triggered
+    std::optional<Price> lastTradePrice;
+    Price tradeLow = std::numeric_limits<Price>::max();
+    Price tradeHigh = std::numeric_limits<Price>::min();
 
     int getOrderId();
-    bool canMatch(Side side, Price price) const;
-    Trades matchOrders();
+    void checkPrice(Price price, OrderType orderType) const;
+    bool canMatch(Side side, Price price);
+    OrderId submitOrder(const OrderId newOrderId, const Price price, const Quantity quantity, const Side side, const OrderType orderType, Trades& trades);
+    OrderId takeLiquidity(const OrderId newOrderId, const Price price, const Quantity quantity, const Side side, const OrderType orderType, Trades& trades);
+    void removeOrder(OrderPtr order);
+    OrderPtr insertOrder(const OrderId newOrderId, const Price price, const Quantity quantity, const Side side, const OrderType orderType);
+    std::optional<Price> getClearingPrice();
+    void journalEvent(JournalRecordType recordType, Side side, OrderType orderType, Price price, Quantity quantity, OrderId orderId, OrderId otherOrderId = INVALID_ORDER_ID);
+    void publishLevel(Side side, const OrderLevel& level, LevelUpdateType type);
+    void matchOrders(Trades& trades, Side incomingSide, std::optional<Price> tradePrice = std::nullopt);
+    void recordTrade(Price price);
+    StopId addStop(const StopOrder& stop, Trades& trades);
+    void triggerStops(Trades& trades);
 };
 
+// heap + map engine
+using Orderbook = BasicOrderbook<HeapLevels>;
+// dense price ladder engine
+using LadderOrderbook = BasicOrderbook<LadderLevels>;
+// ordered tree engine
+using TreeOrderbook = BasicOrderbook<TreeLevels>;
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * Allocation statistics reported by a pool
+ */
+struct PoolStats {
+    std::size_t capacity = 0;      // objects the pool can hold without growing
+    std::size_t inUse = 0;         // objects currently allocated
+    std::size_t highWaterMark = 0; // most objects allocated at once
+    std::size_t misses = 0;        // allocations that found no free object and grew the pool
+    std::size_t chunks = 0;        // chunks allocated
+};
@@ -47,7 +47,7 @@ public:
      *  max: int
      */
     int rndInt(int min, int max) {
-        return (generate() % ((max+1) - min)) + min;
+        return toInt(generate(), min, max);
     }
 
     /*
@@ -57,6 +57,24 @@ public:
      *  max: double
      */
     double rndDouble(double min, double max) {
-        return ((double)generate() / (double)UINT32_MAX) * (max - min) + min;
+        return toDouble(generate(), min, max);
+    }
+
+    /*
+     * Map a generated number to an integer in [min, max] (same mapping as rndInt)
+     */
+    static int toInt(Lehmer32_t value, int min, int max) {
+        // an empty range (max < min) would divide by zero, so clamp to min
+        if (max < min) {
+            return min;
+        }
+        return (value % ((max+1) - min)) + min;
+    }
+
+    /*
+     * Map a generated number to a double in [min, max] (same mapping as rndDouble)
+     */
+    static double toDouble(Lehmer32_t value, double min, double max) {
+        return ((double)value / (double)UINT32_MAX) * (max - min) + min;
     }
 };
\ No newline at end of file
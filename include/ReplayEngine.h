@@ -0,0 +1,166 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <vector>
+#include "OrderEvent.h"
+#include "Journal.h"
+#include "MarketData.h"
+
+// REPLAY SETTINGS
+const std::size_t REPLAY_CHECKPOINT_INTERVAL = 100000; // events between book state checksums
+
+/*
+ * Fold a value into a rolling checksum (splitmix64 finaliser, so nearby values spread out).
+ */
+inline std::uint64_t mixChecksum(std::uint64_t checksum, std::uint64_t value) {
+    std::uint64_t mixed = checksum ^ (value + 0x9e3779b97f4a7c15ULL + (checksum << 6) + (checksum >> 2));
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+    return mixed ^ (mixed >> 31);
+}
+
+/*
+ * Rolling checksum after a number of events: every new order id and trade so far, then the full
+ * depth of the book at that point.
+ */
+struct ReplayCheckpoint {
+    std::size_t events;
+    std::uint64_t checksum;
+};
+
+struct ReplayReport {
+    std::size_t events = 0;
+    std::size_t trades = 0;
+    double seconds = 0;                       // replay time, excluding the book state checksums
+    std::uint64_t checksum = 0;               // final rolling checksum (ends with the final book state)
+    std::vector<ReplayCheckpoint> checkpoints; // one per interval, plus one at the end
+
+    double eventsPerSecond() const {
+        return seconds > 0 ? static_cast<double>(events) / seconds : 0;
+    }
+};
+
+/*
+ * Fold the full depth of a book (live levels, both sides) into a checksum.
+ */
+template<typename Book>
+std::uint64_t checksumBook(Book& orderbook, std::uint64_t checksum) {
+    LevelSnapshot snapshot = orderbook.getLevelSnapshot();
+    for (const LevelInfos* side : {&snapshot.bids, &snapshot.asks}) {
+        checksum = mixChecksum(checksum, side->size());
+        for (const LevelInfo& level : *side) {
+            checksum = mixChecksum(checksum, static_cast<std::uint32_t>(level.price));
+            checksum = mixChecksum(checksum, level.quantity);
+            checksum = mixChecksum(checksum, level.orderCount);
+        }
+    }
+    return mixChecksum(checksum, orderbook.getNumOrders());
+}
+
+/*
+ * Re-drive a book with order events as fast as possible, folding every new order id and trade
+ * into a rolling checksum. Every checkpointInterval events (and at the end) the book state is
+ * folded in too and a checkpoint is recorded. Two engines that behave bit-identically give the same
+ * checkpoints, and the first checkpoint that differs brackets where they diverge.
+ */
+template<typename Book>
+ReplayReport replayEvents(Book& orderbook, const OrderEvent* begin, const OrderEvent* end,
+                          std::size_t checkpointInterval = REPLAY_CHECKPOINT_INTERVAL) {
+    ReplayReport report;
+    std::uint64_t checksum = 0;
+    std::chrono::steady_clock::duration elapsed{0};
+    Trades trades;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const OrderEvent* event = begin; event != end; ++event) {
+        trades.clear();
+        // events that change nothing (cancels of unknown orders) leave the checksum alone
+        OrderId orderId = applyOrderEvent(orderbook, *event, trades);
+        if (orderId != INVALID_ORDER_ID) {
+            checksum = mixChecksum(checksum, static_cast<std::uint64_t>(orderId));
+        }
+        for (Trade& trade : trades) {
+            TradeInfo bid = trade.getBidTrade();
+            TradeInfo ask = trade.getAskTrade();
+            checksum = mixChecksum(checksum, static_cast<std::uint64_t>(bid.orderId));
+            checksum = mixChecksum(checksum, static_cast<std::uint64_t>(ask.orderId));
+            checksum = mixChecksum(checksum, static_cast<std::uint32_t>(bid.price));
+            checksum = mixChecksum(checksum, static_cast<std::uint32_t>(ask.price));
+            checksum = mixChecksum(checksum, bid.quantity);
+        }
+        report.trades += trades.size();
+
+        std::size_t events = static_cast<std::size_t>(event - begin) + 1;
+        if (checkpointInterval > 0 && events % checkpointInterval == 0 && event + 1 != end) {
+            elapsed += std::chrono::steady_clock::now() - start;
+            checksum = checksumBook(orderbook, checksum);
+            report.checkpoints.push_back(ReplayCheckpoint{events, checksum});
+            start = std::chrono::steady_clock::now();
+        }
+    }
+    elapsed += std::chrono::steady_clock::now() - start;
+
+    report.events = static_cast<std::size_t>(end - begin);
+    report.seconds = std::chrono::duration<double>(elapsed).count();
+    report.checksum = checksumBook(orderbook, checksum);
+    report.checkpoints.push_back(ReplayCheckpoint{report.events, report.checksum});
+    return report;
+}
+
+/*
+ * The number of events at the first checkpoint where two replays differ, or nullopt if they match.
+ */
+inline std::optional<std::size_t> firstDivergence(const ReplayReport& lhs, const ReplayReport& rhs) {
+    std::size_t count = std::min(lhs.checkpoints.size(), rhs.checkpoints.size());
+    for (std::size_t i = 0; i < count; i++) {
+        if (lhs.checkpoints[i].events != rhs.checkpoints[i].events || lhs.checkpoints[i].checksum != rhs.checkpoints[i].checksum) {
+            return lhs.checkpoints[i].events;
+        }
+    }
+    if (lhs.checkpoints.size() != rhs.checkpoints.size() || lhs.trades != rhs.trades) {
+        return std::min(lhs.events, rhs.events);
+    }
+    return std::nullopt;
+}
+
+/*
+ * Rebuild the order events (adds, cancels and modifies) from a journal. Rejects and trades are
+ * outputs of the book, so they are left out: replaying the events reproduces them. Orders added
+ * through a call auction batch come back as single adds, so they replay as continuous matching.
+ */
+inline std::vector<OrderEvent> journalToEvents(const std::vector<JournalRecord>& records) {
+    std::vector<OrderEvent> events;
+    events.reserve(records.size());
+    for (const JournalRecord& record : records) {
+        OrderEvent event{};
+        event.side = record.side;
+        event.orderType = record.orderType;
+        event.price = record.price;
+        event.quantity = record.quantity;
+        event.orderId = record.orderId;
+        switch (record.recordType) {
+            case JournalRecordType::Add:
+                event.eventType = OrderEventType::Add;
+                event.orderId = INVALID_ORDER_ID;
+                break;
+            case JournalRecordType::Cancel:
+                event.eventType = OrderEventType::Cancel;
+                break;
+            case JournalRecordType::Modify:
+                event.eventType = OrderEventType::Modify;
+                break;
+            case JournalRecordType::Reject:
+            case JournalRecordType::Trade:
+                continue;
+            // a triggered stop is journaled as an Add when it fires, so stops replay as plain orders
+            case JournalRecordType::Stop:
+            case JournalRecordType::StopCancel:
+                continue;
+        }
+        events.push_back(event);
+    }
+    return events;
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "Orderbook.h"
+#include "OrderEvent.h"
+#include "SpscRing.h"
+#include "ThreadAffinity.h"
+
+// order event for one instrument
+struct InstrumentEvent {
+    InstrumentId instrument;
+    OrderEvent event;
+};
+
+struct ShardStats {
+    std::size_t events = 0; // events applied
+    std::size_t trades = 0; // trades produced
+    std::size_t books = 0;  // instruments owned by the shard
+};
+
+/*
+ * ShardedEngine Class
+ *
+ * Multi-instrument matching engine. Books are keyed by instrument id and partitioned across shards
+ * (instrument % number of shards). Each shard owns its books, an inbound SpscRing, and a matching
+ * thread pinned to its own core, so shards never share state and scale with the number of cores.
+ *
+ * Events are submitted from a single producer thread. Books are created on the first event for
+ * their instrument, using the book factory.
+ */
+template<typename Book>
+class ShardedEngine {
+public:
+    using BookFactory = std::function<std::unique_ptr<Book>(InstrumentId)>;
+
+    ShardedEngine(std::size_t numShards, std::size_t queueCapacity = 1 << 16,
+                  BookFactory bookFactory = [](InstrumentId) { return std::make_unique<Book>(); },
+                  bool pinThreads = true)
+        : bookFactory(std::move(bookFactory)) {
+        if (numShards == 0) {
+            throw std::invalid_argument("ShardedEngine needs at least one shard");
+        }
+        for (std::size_t i = 0; i < numShards; ++i) {
+            shards.push_back(std::make_unique<Shard>(queueCapacity));
+        }
+        for (std::size_t i = 0; i < numShards; ++i) {
+            Shard& shard = *shards[i];
+            shard.worker = std::thread([this, &shard] { run(shard); });
+            if (pinThreads) {
+                pinThreadToCore(shard.worker, static_cast<unsigned>(i));
+            }
+        }
+    }
+
+    // stops the shards once their queues are drained
+    ~ShardedEngine() {
+        running.store(false, std::memory_order_release);
+        for (auto& shard : shards) {
+            shard->worker.join();
+        }
+    }
+
+    ShardedEngine(const ShardedEngine&) = delete;
+    ShardedEngine& operator=(const ShardedEngine&) = delete;
+
+    /*
+    * Queue an event for an instrument (producer thread only). Waits if the shard's queue is full.
+    */
+    void submit(InstrumentId instrument, const OrderEvent& event) {
+        Shard& shard = *shards[shardOf(instrument)];
+        InstrumentEvent instrumentEvent{instrument, event};
+        while (!shard.queue.tryPush(instrumentEvent)) {
+            std::this_thread::yield();
+        }
+        ++shard.submitted;
+    }
+
+    /*
+    * Wait until every submitted event has been applied (producer thread only).
+    */
+    void flush() {
+        for (auto& shard : shards) {
+            while (shard->processed.load(std::memory_order_acquire) != shard->submitted) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    std::size_t getNumShards() const {
+        return shards.size();
+    }
+
+    std::size_t shardOf(InstrumentId instrument) const {
+        return instrument % shards.size();
+    }
+
+    /*
+    * Shard statistics. Only consistent after flush().
+    */
+    ShardStats getShardStats(std::size_t shard) const {
+        ShardStats stats;
+        stats.events = shards[shard]->processed.load(std::memory_order_acquire);
+        stats.trades = shards[shard]->trades;
+        stats.books = shards[shard]->books.size();
+        return stats;
+    }
+
+    /*
+    * Book for an instrument, or nullptr if it has no events yet. Only safe to use after flush().
+    */
+    Book* getBook(InstrumentId instrument) {
+        auto& books = shards[shardOf(instrument)]->books;
+        auto it = books.find(instrument);
+        return it == books.end() ? nullptr : it->second.get();
+    }
+
+private:
+    struct Shard {
+        explicit Shard(std::size_t queueCapacity) : queue(queueCapacity) {}
+
+        SpscRing<InstrumentEvent> queue;
+        std::unordered_map<InstrumentId, std::unique_ptr<Book>> books;
+        std::atomic<std::size_t> processed{0};
+        std::size_t submitted = 0; // producer side count
+        std::size_t trades = 0;
+        std::thread worker;
+    };
+
+    BookFactory bookFactory;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::atomic<bool> running{true};
+
+    /*
+    * Matching loop for a shard: drain the queue into the books until the engine stops.
+    */
+    void run(Shard& shard) {
+        Trades trades;
+        InstrumentEvent instrumentEvent;
+        InstrumentId lastInstrument = 0;
+        Book* book = nullptr;
+
+        while (true) {
+            if (!shard.queue.tryPop(instrumentEvent)) {
+                if (!running.load(std::memory_order_acquire) && shard.queue.empty()) {
+                    return;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+
+            // consecutive events often hit the same instrument
+            if (book == nullptr || instrumentEvent.instrument != lastInstrument) {
+                auto& slot = shard.books[instrumentEvent.instrument];
+                if (!slot) {
+                    slot = bookFactory(instrumentEvent.instrument);
+                }
+                book = slot.get();
+                lastInstrument = instrumentEvent.instrument;
+            }
+
+            trades.clear();
+            applyOrderEvent(*book, instrumentEvent.event, trades);
+            shard.trades += trades.size();
+            shard.processed.fetch_add(1, std::memory_order_release);
+        }
+    }
+};
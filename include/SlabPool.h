@@ -0,0 +1,166 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include "PoolStats.h"
+
+/*
+ * SlabPool Class
+ *
+ * A templated slab allocator. Objects are carved out of large contiguous chunks, and free objects
+ * are kept in an intrusive free list threaded through their own storage, so allocate/deallocate
+ * never touch the heap once a chunk exists. When the free list runs dry the pool grows by a whole chunk.
+ *
+ * Each object has a 32-bit handle (its index in the pool) which can be used instead of a pointer.
+ * Chunks are aligned to their size, so the handle of an object is found from its address.
+ *
+ * Objects still allocated when the pool is destroyed are released without running their destructors.
+ */
+template<typename T, std::size_t ChunkBytes = (1 << 18)>
+class SlabPool {
+public:
+    using Handle = std::uint32_t;
+    static constexpr Handle NULL_HANDLE = std::numeric_limits<Handle>::max();
+
+    // constructor to preallocate enough chunks for a given number of objects
+    SlabPool(std::size_t preallocateSize = SLOTS_PER_CHUNK) {
+        reserve(preallocateSize);
+    }
+
+    // destructor to release the chunks
+    ~SlabPool() {
+        for (unsigned char* chunk : chunks) {
+            ::operator delete(chunk, std::align_val_t(ChunkBytes));
+        }
+    }
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    /*
+    * Allocate an object from the pool, growing the pool by a chunk if no objects are free.
+    */
+    T* allocate() {
+        return get(allocateHandle());
+    }
+
+    /*
+    * Deallocate an object and return it to the pool.
+    */
+    void deallocate(T* obj) {
+        if (obj != nullptr) {
+            deallocate(handleOf(obj));
+        }
+    }
+
+    /*
+    * Allocate an object from the pool and return its handle.
+    */
+    Handle allocateHandle() {
+        if (freeHead == NULL_HANDLE) {
+            ++stats.misses;
+            grow();
+        }
+
+        Handle handle = freeHead;
+        Slot* slot = slotAt(handle);
+        freeHead = slot->nextFree;
+        new (slot->storage) T();
+
+        if (++stats.inUse > stats.highWaterMark) {
+            stats.highWaterMark = stats.inUse;
+        }
+        return handle;
+    }
+
+    /*
+    * Deallocate an object by handle and return it to the pool.
+    */
+    void deallocate(Handle handle) {
+        Slot* slot = slotAt(handle);
+        reinterpret_cast<T*>(slot->storage)->~T();
+        slot->nextFree = freeHead;
+        freeHead = handle;
+        --stats.inUse;
+    }
+
+    /*
+    * Get the object for a handle.
+    */
+    T* get(Handle handle) const {
+        return reinterpret_cast<T*>(slotAt(handle)->storage);
+    }
+
+    /*
+    * Get the handle of an object allocated from this pool.
+    */
+    Handle handleOf(const T* obj) const {
+        auto address = reinterpret_cast<std::uintptr_t>(obj);
+        auto chunk = reinterpret_cast<const unsigned char*>(address & ~static_cast<std::uintptr_t>(ChunkBytes - 1));
+        Handle firstHandle = *reinterpret_cast<const Handle*>(chunk);
+        return firstHandle + static_cast<Handle>((reinterpret_cast<const unsigned char*>(obj) - chunk - SLOTS_OFFSET) / sizeof(Slot));
+    }
+
+    /*
+    * Grow the pool (by whole chunks) until it can hold at least capacity objects.
+    */
+    void reserve(std::size_t capacity) {
+        while (stats.capacity < capacity) {
+            grow();
+        }
+    }
+
+    const PoolStats& getStats() const {
+        return stats;
+    }
+
+private:
+    // a slot holds either a live object or the handle of the next free slot
+    union Slot {
+        Handle nextFree;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // each chunk starts with the handle of its first slot, followed by the slots
+    static constexpr std::size_t SLOTS_OFFSET = ((sizeof(Handle) + alignof(Slot) - 1) / alignof(Slot)) * alignof(Slot);
+    static constexpr std::size_t SLOTS_PER_CHUNK = (ChunkBytes - SLOTS_OFFSET) / sizeof(Slot);
+
+    static_assert((ChunkBytes & (ChunkBytes - 1)) == 0, "ChunkBytes must be a power of two");
+    static_assert(SLOTS_PER_CHUNK > 0, "ChunkBytes is too small to hold an object");
+
+    std::vector<unsigned char*> chunks;
+    Handle freeHead = NULL_HANDLE;
+    PoolStats stats;
+
+    Slot* slotAt(Handle handle) const {
+        unsigned char* chunk = chunks[handle / SLOTS_PER_CHUNK];
+        return reinterpret_cast<Slot*>(chunk + SLOTS_OFFSET) + (handle % SLOTS_PER_CHUNK);
+    }
+
+    /*
+    * Allocate a new chunk and push all of its slots onto the free list (in address order).
+    */
+    void grow() {
+        if (stats.capacity + SLOTS_PER_CHUNK >= NULL_HANDLE) {
+            throw std::length_error("SlabPool handle space exhausted");
+        }
+
+        auto chunk = static_cast<unsigned char*>(::operator new(ChunkBytes, std::align_val_t(ChunkBytes)));
+        Handle firstHandle = static_cast<Handle>(stats.capacity);
+        *reinterpret_cast<Handle*>(chunk) = firstHandle;
+        chunks.push_back(chunk);
+
+        Slot* slots = reinterpret_cast<Slot*>(chunk + SLOTS_OFFSET);
+        for (std::size_t i = SLOTS_PER_CHUNK; i-- > 0;) {
+            slots[i].nextFree = freeHead;
+            freeHead = firstHandle + static_cast<Handle>(i);
+        }
+
+        stats.capacity += SLOTS_PER_CHUNK;
+        ++stats.chunks;
+    }
+};
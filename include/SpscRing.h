@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+/*
+ * SpscRing Class
+ *
+ * A bounded lock-free single-producer/single-consumer ring buffer. One thread may push and one
+ * (other) thread may pop. The capacity is rounded up to a power of two.
+ *
+ * Each side keeps a cached copy of the other side's index, so the shared indexes are only read
+ * when the ring looks full (producer) or empty (consumer).
+ */
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity) {
+        if (capacity == 0) {
+            throw std::invalid_argument("SpscRing capacity must be positive");
+        }
+        std::size_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /*
+    * Push an item (producer only). Returns false if the ring is full.
+    */
+    bool tryPush(const T& item) {
+        std::size_t head = producer.index.load(std::memory_order_relaxed);
+        if (head - producer.cachedIndex > mask) {
+            producer.cachedIndex = consumer.index.load(std::memory_order_acquire);
+            if (head - producer.cachedIndex > mask) {
+                return false;
+            }
+        }
+        slots[head & mask] = item;
+        producer.index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+    * Pop an item (consumer only). Returns false if the ring is empty.
+    */
+    bool tryPop(T& item) {
+        std::size_t tail = consumer.index.load(std::memory_order_relaxed);
+        if (tail == consumer.cachedIndex) {
+            consumer.cachedIndex = producer.index.load(std::memory_order_acquire);
+            if (tail == consumer.cachedIndex) {
+                return false;
+            }
+        }
+        item = slots[tail & mask];
+        consumer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*
+    * Pop up to maxItems items into out (consumer only), publishing the new tail once for the
+    * whole batch. Returns the number of items popped.
+    */
+    std::size_t popBatch(T* out, std::size_t maxItems) {
+        std::size_t tail = consumer.index.load(std::memory_order_relaxed);
+        if (consumer.cachedIndex - tail < maxItems) {
+            consumer.cachedIndex = producer.index.load(std::memory_order_acquire);
+        }
+        std::size_t count = std::min(maxItems, consumer.cachedIndex - tail);
+        for (std::size_t i = 0; i < count; ++i) {
+            out[i] = slots[(tail + i) & mask];
+        }
+        if (count > 0) {
+            consumer.index.store(tail + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    bool empty() const {
+        return consumer.index.load(std::memory_order_acquire) == producer.index.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    // each side on its own cache line to avoid false sharing
+    struct alignas(64) Cursor {
+        std::atomic<std::size_t> index{0};
+        std::size_t cachedIndex = 0; // last seen index of the other side
+    };
+
+    Cursor producer;
+    Cursor consumer;
+    std::vector<T> slots;
+    std::size_t mask;
+};
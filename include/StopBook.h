@@ -0,0 +1,134 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include "Types.h"
+#include "Side.h"
+#include "OrderType.h"
+
+using StopId = std::int64_t;
+
+/*
+ * A pending stop: once a trade prints at or through its trigger price (at or above for a buy,
+ * at or below for a sell) it is injected into the book as an order of orderType at limitPrice.
+ */
+struct StopOrder {
+    StopId stopId;
+    Price triggerPrice;
+    Price limitPrice;
+    Quantity quantity;
+    Side side;
+    OrderType orderType;
+};
+
+/*
+ * A stop that has been triggered, and the id of the order it was injected as.
+ */
+struct StopTrigger {
+    StopId stopId;
+    OrderId orderId;
+};
+
+using StopTriggers = std::vector<StopTrigger>;
+
+/*
+ * StopBook Class
+ *
+ * Trigger index of pending stops, in one bucket per trigger price (tick) on each side. Buckets are
+ * kept in an ordered map in the order a rising (buy stops) or falling (sell stops) price reaches
+ * them, so the stops a trade range triggers are always at the front: triggering walks only the
+ * buckets it empties, and costs O(log n) plus the number of stops triggered however many rest.
+ *
+ * Triggered stops come out in a fixed order: buy stops by rising trigger price, then sell stops
+ * by falling trigger price, first placed first within a bucket.
+ */
+class StopBook {
+public:
+    void add(const StopOrder& stop) {
+        if (stop.side == Side::Buy) {
+            buyStops[stop.triggerPrice].push_back(stop);
+        } else {
+            sellStops[stop.triggerPrice].push_back(stop);
+        }
+        index[stop.stopId] = TriggerKey{stop.side, stop.triggerPrice};
+    }
+
+    /*
+    * Remove a pending stop. Returns false if there is no such stop (unknown or already triggered).
+    */
+    bool cancel(StopId stopId) {
+        auto found = index.find(stopId);
+        if (found == index.end()) {
+            return false;
+        }
+        TriggerKey key = found->second;
+        index.erase(found);
+        if (key.side == Side::Buy) {
+            removeFrom(buyStops, key.triggerPrice, stopId);
+        } else {
+            removeFrom(sellStops, key.triggerPrice, stopId);
+        }
+        return true;
+    }
+
+    /*
+    * Move every stop triggered by trades printed between low and high (inclusive) to the back of
+    * triggered, in trigger order.
+    */
+    void trigger(Price low, Price high, std::deque<StopOrder>& triggered) {
+        takeTriggered(buyStops, [high](Price triggerPrice) { return triggerPrice <= high; }, triggered);
+        takeTriggered(sellStops, [low](Price triggerPrice) { return triggerPrice >= low; }, triggered);
+    }
+
+    std::size_t size() const {
+        return index.size();
+    }
+
+    bool empty() const {
+        return index.empty();
+    }
+
+private:
+    struct TriggerKey {
+        Side side;
+        Price triggerPrice;
+    };
+
+    using Bucket = std::vector<StopOrder>;
+
+    // buy stops trigger on the way up (lowest trigger first), sell stops on the way down (highest first)
+    std::map<Price, Bucket> buyStops;
+    std::map<Price, Bucket, std::greater<Price>> sellStops;
+
+    // stop id to its bucket, for cancels
+    std::unordered_map<StopId, TriggerKey> index;
+
+    template<typename Buckets, typename Triggered>
+    void takeTriggered(Buckets& buckets, Triggered isTriggered, std::deque<StopOrder>& triggered) {
+        while (!buckets.empty() && isTriggered(buckets.begin()->first)) {
+            for (const StopOrder& stop : buckets.begin()->second) {
+                triggered.push_back(stop);
+                index.erase(stop.stopId);
+            }
+            buckets.erase(buckets.begin());
+        }
+    }
+
+    template<typename Buckets>
+    static void removeFrom(Buckets& buckets, Price triggerPrice, StopId stopId) {
+        auto bucket = buckets.find(triggerPrice);
+        Bucket& stops = bucket->second;
+        for (auto it = stops.begin(); it != stops.end(); ++it) {
+            if (it->stopId == stopId) {
+                stops.erase(it);
+                break;
+            }
+        }
+        if (stops.empty()) {
+            buckets.erase(bucket);
+        }
+    }
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#endif
+
+/*
+ * Pin a thread to a core (modulo the number of cores). Returns false if pinning is not supported
+ * on this platform or failed, in which case the thread is left to the scheduler.
+ */
+inline bool pinThreadToCore(std::thread& thread, unsigned core) {
+#ifdef __linux__
+    unsigned cores = std::thread::hardware_concurrency();
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cores == 0 ? 0 : core % cores, &cpuSet);
+    return pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpuSet) == 0;
+#else
+    (void)thread;
+    (void)core;
+    return false;
+#endif
+}
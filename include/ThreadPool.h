@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+ * ThreadPool Class
+ *
+ * A fixed pool of worker threads for data-parallel loops. parallelFor splits a range into one
+ * contiguous chunk per thread (the calling thread takes the first chunk) and returns once every
+ * chunk has been run.
+ */
+class ThreadPool {
+public:
+    using ChunkFn = std::function<void(std::size_t begin, std::size_t end)>;
+
+    // numThreads includes the calling thread, so numThreads - 1 workers are started
+    explicit ThreadPool(std::size_t numThreads) {
+        for (std::size_t i = 1; i < numThreads; ++i) {
+            workers.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobReady.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    std::size_t size() const {
+        return workers.size() + 1;
+    }
+
+    /*
+    * Run fn over [0, count) split into one chunk per thread, blocking until all chunks are done.
+    */
+    void parallelFor(std::size_t count, const ChunkFn& fn) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &fn;
+            jobCount = count;
+            pending = workers.size();
+            ++generation;
+        }
+        jobReady.notify_all();
+
+        runChunk(0, fn, count);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        jobDone.wait(lock, [this] { return pending == 0; });
+        job = nullptr;
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    std::condition_variable jobDone;
+    const ChunkFn* job = nullptr;
+    std::size_t jobCount = 0;
+    std::size_t pending = 0;
+    std::size_t generation = 0;
+    bool stopping = false;
+
+    void runChunk(std::size_t chunk, const ChunkFn& fn, std::size_t count) {
+        std::size_t chunks = size();
+        std::size_t begin = count * chunk / chunks;
+        std::size_t end = count * (chunk + 1) / chunks;
+        if (begin < end) {
+            fn(begin, end);
+        }
+    }
+
+    void run(std::size_t chunk) {
+        std::size_t seenGeneration = 0;
+        while (true) {
+            const ChunkFn* fn;
+            std::size_t count;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                jobReady.wait(lock, [&] { return stopping || generation != seenGeneration; });
+                if (stopping) {
+                    return;
+                }
+                seenGeneration = generation;
+                fn = job;
+                count = jobCount;
+            }
+
+            runChunk(chunk, *fn, count);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0) {
+                jobDone.notify_one();
+            }
+        }
+    }
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Types.h"
+#include "LatencyHistogram.h"
+
+/*
+ * Time sources for order timestamps
+ *
+ * Priority within a level comes from its FIFO position, so an order's time is only a record of when
+ * the book accepted it. A book takes its time source as a policy: now() is called once per order
+ * inserted and nothing else is ever read from a clock on the hot path.
+ */
+
+/*
+ * Logical time: the n-th order stamped gets n. Free, and the same inputs always give the same
+ * timestamps, so simulations and replays are reproducible.
+ */
+class SequenceClock {
+public:
+    Time now() {
+        return ++time;
+    }
+
+private:
+    Time time = 0;
+};
+
+/*
+ * Wall time in cycles of the cycle counter (the TSC on x86), no system call.
+ * Divide by cyclesPerNanosecond() for nanoseconds.
+ */
+class TscClock {
+public:
+    Time now() {
+        return readCycleCounter();
+    }
+};
+
+/*
+ * Simulation time supplied by the caller (e.g. the agent loop's time step). Every order stamped
+ * until the next setTime gets the same time.
+ */
+class SimulationClock {
+public:
+    Time now() {
+        return time;
+    }
+
+    void setTime(Time newTime) {
+        time = newTime;
+    }
+
+private:
+    Time time = 0;
+};
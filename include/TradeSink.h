@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include "Trade.h"
+
+/*
+ * Trade sinks
+ *
+ * Every trade the book makes is handed to its TradeSink policy as it is made, on top of being
+ * appended to the caller's Trades buffer. The call is resolved at compile time, so a book with
+ * NoTradeSink pays nothing for it.
+ */
+
+/*
+ * Drops every trade (the default).
+ */
+struct NoTradeSink {
+    void onTrade(const TradeInfo&, const TradeInfo&) {}
+};
+
+/*
+ * Counts the trades and the volume traded since the book was created.
+ */
+class TradeCounter {
+public:
+    void onTrade(const TradeInfo& bidTrade, const TradeInfo&) {
+        ++trades;
+        volume += bidTrade.quantity;
+    }
+
+    std::uint64_t getTrades() const {
+        return trades;
+    }
+
+    std::uint64_t getVolume() const {
+        return volume;
+    }
+
+private:
+    std::uint64_t trades = 0;
+    std::uint64_t volume = 0;
+};
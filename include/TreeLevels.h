@@ -0,0 +1,169 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include "OrderLevel.h"
+#include "DepthKernels.h"
+#include "Side.h"
+
+/*
+ * TreeLevels Class
+ *
+ * Level index for the Orderbook backed by an ordered tree (std::map) of levels on each side, bids
+ * sorted best (highest) first and asks best (lowest) first. Any price can rest in the book and
+ * the levels are always in price order, so depth reads walk the live levels in order without a
+ * sort, at the cost of a tree lookup per insert.
+ *
+ * Levels are removed as soon as they are emptied (by a fill or a cancel), so the level counts only
+ * include live levels. Tree nodes never move, so a level stays put while it is live.
+ */
+class TreeLevels {
+public:
+    /*
+    * Whether a price can rest in the book (any price can).
+    */
+    bool contains(Price) const {
+        return true;
+    }
+
+    /*
+    * Get the level at a price, creating it if it doesn't exist.
+    */
+    OrderLevel& getOrCreate(Side side, Price price) {
+        OrderLevel& level = (side == Side::Buy) ? bidLevels[price] : askLevels[price];
+        level.price = price;
+        return level;
+    }
+
+    /*
+    * Get the best level on a side, or nullptr if the side is empty.
+    */
+    OrderLevel* best(Side side) {
+        if (side == Side::Buy) {
+            return bidLevels.empty() ? nullptr : &bidLevels.begin()->second;
+        }
+        return askLevels.empty() ? nullptr : &askLevels.begin()->second;
+    }
+
+    /*
+    * Remove the best level on a side, called once matching has emptied it.
+    */
+    void popBest(Side side) {
+        if (side == Side::Buy) {
+            bidLevels.erase(bidLevels.begin());
+        } else {
+            askLevels.erase(askLevels.begin());
+        }
+    }
+
+    /*
+    * Remove an emptied level.
+    */
+    void release(Side side, OrderLevel& level) {
+        if (side == Side::Buy) {
+            bidLevels.erase(level.price);
+        } else {
+            askLevels.erase(level.price);
+        }
+    }
+
+    std::size_t size(Side side) const {
+        return (side == Side::Buy) ? bidLevels.size() : askLevels.size();
+    }
+
+    /*
+    * Called whenever a level's aggregate changes (nothing to keep in step here).
+    */
+    void update(Side, const OrderLevel&) {}
+
+    /*
+    * Total quantity resting on a side within ticks price ticks of its best price (the best included).
+    */
+    std::uint64_t bandQuantity(Side side, std::size_t ticks) {
+        OrderLevel* level = best(side);
+        std::uint64_t total = 0;
+        if (level == nullptr || ticks == 0) {
+            return total;
+        }
+        forEachWithin(side, bandLimit(side, level->price, ticks), [&total](const OrderLevel& within) {
+            total += within.totalQuantity;
+        });
+        return total;
+    }
+
+    /*
+    * What taking quantity from a side, best price first and no further than limit, would fill and cost.
+    */
+    SweepCost sweep(Side side, Quantity quantity, Price limit) const {
+        if (side == Side::Buy) {
+            return sweepLevels(side, bidLevels, quantity, limit);
+        }
+        return sweepLevels(side, askLevels, quantity, limit);
+    }
+
+    /*
+    * Visit every live level on a side from best to worst price.
+    */
+    template<typename Fn>
+    void forEach(Side side, Fn fn) const {
+        if (side == Side::Buy) {
+            for (const auto& level : bidLevels) {
+                fn(level.second);
+            }
+        } else {
+            for (const auto& level : askLevels) {
+                fn(level.second);
+            }
+        }
+    }
+
+    /*
+    * Visit every live level on a side priced at or better than limit (bids >= limit, asks <= limit),
+    * from best to worst price.
+    */
+    template<typename Fn>
+    void forEachWithin(Side side, Price limit, Fn fn) const {
+        if (side == Side::Buy) {
+            for (auto it = bidLevels.begin(); it != bidLevels.end() && it->first >= limit; ++it) {
+                fn(it->second);
+            }
+        } else {
+            for (auto it = askLevels.begin(); it != askLevels.end() && it->first <= limit; ++it) {
+                fn(it->second);
+            }
+        }
+    }
+
+    /*
+    * Write up to maxLevels levels on a side into out, from best to worst price.
+    * Returns the number of levels written.
+    */
+    std::size_t depth(Side side, LevelInfo* out, std::size_t maxLevels) const {
+        if (side == Side::Buy) {
+            return copyLevels(bidLevels, out, maxLevels);
+        }
+        return copyLevels(askLevels, out, maxLevels);
+    }
+
+private:
+    std::map<Price, OrderLevel, std::greater<Price>> bidLevels;
+    std::map<Price, OrderLevel> askLevels;
+
+    template<typename Levels>
+    static SweepCost sweepLevels(Side side, const Levels& levels, Quantity quantity, Price limit) {
+        SweepCost cost;
+        for (auto it = levels.begin(); it != levels.end() && cost.quantity < quantity && withinLimit(side, it->first, limit); ++it) {
+            takeLevel(cost, it->first, it->second.totalQuantity, quantity);
+        }
+        return cost;
+    }
+
+    template<typename Levels>
+    static std::size_t copyLevels(const Levels& levels, LevelInfo* out, std::size_t maxLevels) {
+        std::size_t count = 0;
+        for (auto it = levels.begin(); it != levels.end() && count < maxLevels; ++it) {
+            out[count++] = it->second.getInfo();
+        }
+        return count;
+    }
+};
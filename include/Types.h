@@ -8,12 +8,17 @@
 using Price = std::int32_t;
 using Quantity = std::uint32_t;
 using OrderId = std::int64_t;
-using Time = std::chrono::time_point<std::chrono::system_clock>;
+using InstrumentId = std::uint32_t;
+using Time = std::uint64_t; // in the units of the book's time source (see TimeSource.h)
+
+// id returned for orders that were rejected (or don't exist)
+const OrderId INVALID_ORDER_ID = -1;
 
 // Level types
 struct LevelInfo {
     Price price;
     Quantity quantity;
+    std::uint32_t orderCount = 0;
 };
 
 using LevelInfos = std::vector<LevelInfo>;
\ No newline at end of file
@@ -0,0 +1,96 @@
+#include "AgentPopulation.h"
+
+AgentPopulation::AgentPopulation(Orderbook& orderbook)
+    : orderbook(orderbook) {}
+
+void AgentPopulation::reserve(std::size_t agents) {
+    seeds.reserve(agents);
+    cash.reserve(agents);
+    holdings.reserve(agents);
+    pendingHeads.reserve(agents);
+}
+
+std::size_t AgentPopulation::addAgent(Lehmer32_t seed) {
+    seeds.push_back(seed);
+    cash.push_back(STARTING_CASH);
+    holdings.push_back(0);
+    pendingHeads.push_back(NO_PENDING);
+    return seeds.size() - 1;
+}
+
+void AgentPopulation::step(Lehmer32_t timeStep) {
+    for (std::size_t agent = 0; agent < seeds.size(); ++agent) {
+        AgentIntent intent = BacktestAgent::planIntent(seeds[agent], timeStep, pendingHeads[agent] != NO_PENDING);
+        if (!intent.hasAction) {
+            continue;
+        }
+
+        switch (intent.action) {
+            case ActionType::AddOrder: {
+                Action action = BacktestAgent::getActionDetails(intent, cash[agent], holdings[agent], orderbook);
+                trades.clear();
+                OrderId orderId = orderbook.addOrder(action.price, action.quantity, action.side, action.orderType, trades);
+                if (orderId != INVALID_ORDER_ID) {
+                    pushPending(agent, orderId);
+                }
+                BacktestAgent::updatePosition(action, cash[agent], holdings[agent]);
+                break;
+            }
+            case ActionType::ModifyOrder: {
+                Action action = BacktestAgent::getActionDetails(intent, cash[agent], holdings[agent], orderbook);
+                OrderId orderId = popPending(agent);
+                trades.clear();
+                OrderId newOrderId = orderbook.modifyOrder(orderId, action.price, action.quantity, action.side, trades);
+                if (newOrderId != INVALID_ORDER_ID) {
+                    pushPending(agent, newOrderId);
+                }
+                break;
+            }
+            case ActionType::CancelOrder:
+                orderbook.cancelOrder(popPending(agent));
+                break;
+        }
+    }
+}
+
+std::size_t AgentPopulation::size() const {
+    return seeds.size();
+}
+
+Cash AgentPopulation::getCash(std::size_t agent) const {
+    return cash[agent];
+}
+
+Holdings AgentPopulation::getHoldings(std::size_t agent) const {
+    return holdings[agent];
+}
+
+std::size_t AgentPopulation::getNumPendingOrders(std::size_t agent) const {
+    std::size_t count = 0;
+    for (PendingIndex node = pendingHeads[agent]; node != NO_PENDING; node = pendingNext[node]) {
+        ++count;
+    }
+    return count;
+}
+
+void AgentPopulation::pushPending(std::size_t agent, OrderId orderId) {
+    PendingIndex node = freePending;
+    if (node == NO_PENDING) {
+        node = static_cast<PendingIndex>(pendingOrderIds.size());
+        pendingOrderIds.push_back(orderId);
+        pendingNext.push_back(pendingHeads[agent]);
+    } else {
+        freePending = pendingNext[node];
+        pendingOrderIds[node] = orderId;
+        pendingNext[node] = pendingHeads[agent];
+    }
+    pendingHeads[agent] = node;
+}
+
+OrderId AgentPopulation::popPending(std::size_t agent) {
+    PendingIndex node = pendingHeads[agent];
+    pendingHeads[agent] = pendingNext[node];
+    pendingNext[node] = freePending;
+    freePending = node;
+    return pendingOrderIds[node];
+}
@@ -0,0 +1,30 @@
+#include "AgentSimulation.h"
+
+AgentSimulation::AgentSimulation(std::vector<BacktestAgent>& agents, std::size_t numThreads)
+    : agents(agents) {
+    if (numThreads > 1) {
+        pool = std::make_unique<ThreadPool>(numThreads);
+    }
+}
+
+void AgentSimulation::step(Lehmer32_t timeStep) {
+    if (!pool) {
+        for (auto& agent : agents) {
+            agent.generateAction(timeStep);
+        }
+        return;
+    }
+
+    // plan every agent's intent in parallel
+    intents.resize(agents.size());
+    pool->parallelFor(agents.size(), [this, timeStep](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            intents[i] = agents[i].planAction(timeStep);
+        }
+    });
+
+    // apply them in a fixed order
+    for (std::size_t i = 0; i < agents.size(); ++i) {
+        agents[i].applyIntent(intents[i]);
+    }
+}
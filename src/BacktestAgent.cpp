@@ -3,23 +3,25 @@
 BacktestAgent::BacktestAgent(Lehmer32_t seed, Orderbook& orderbook)
     : seed(seed), orderbook(orderbook) {}
 
-Price BacktestAgent::getBestPrice(Side side) {
+Price BacktestAgent::getBestPrice(Orderbook& orderbook, Side side) {
     if (USE_FAIR_PRICE) {
         return FAIR_PRICE;
     }
 
-    OrderBookLevelInfos orderInfos = orderbook.getOrderInfos();
-    if (side == Side::Buy) {
-        return orderInfos.getBids().size() == 0 ? NO_PRICE_OFFER : orderInfos.getBids().front().price;
-    } else {
-        return orderInfos.getAsks().size() == 0 ? NO_PRICE_OFFER : orderInfos.getAsks().front().price;
-    }
+    std::optional<Price> bestPrice = (side == Side::Buy) ? orderbook.getBestBid() : orderbook.getBestAsk();
+    return bestPrice.value_or(NO_PRICE_OFFER);
 }
 
 void BacktestAgent::addOrder(Action action) {
-    OrderConfirmation confirmation = orderbook.addOrder(action.price, action.quantity, action.side, action.orderType);
-    orders.insert(confirmation.first);
+    trades.clear();
+    OrderId orderId = orderbook.addOrder(action.price, action.quantity, action.side, action.orderType, trades);
+    if (orderId != INVALID_ORDER_ID) {
+        orders.push_back(orderId);
+    }
+    updatePosition(action, cash, holdings);
+}
 
+void BacktestAgent::updatePosition(const Action& action, Cash& cash, Holdings& holdings) {
     if (action.side == Side::Buy) {
         cash -= action.price * action.quantity;
         holdings += action.quantity;
@@ -29,54 +31,116 @@ void BacktestAgent::addOrder(Action action) {
     }
 }
 
+// only the most recent pending order is ever modified or cancelled, so it is the one popped
 void BacktestAgent::modifyOrder(const OrderId orderId, Action action) {
-    orders.erase(orderId);
-    orders.insert(orderbook.modifyOrder(orderId, action.price, action.quantity, action.side).first);
+    orders.pop_back();
+    trades.clear();
+    OrderId newOrderId = orderbook.modifyOrder(orderId, action.price, action.quantity, action.side, trades);
+    if (newOrderId != INVALID_ORDER_ID) {
+        orders.push_back(newOrderId);
+    }
 }
 
 void BacktestAgent::cancelOrder(const OrderId orderId) {
-    orders.erase(orderId);
+    orders.pop_back();
     orderbook.cancelOrder(orderId);
 }
 
 void BacktestAgent::generateAction(Lehmer32_t timeStep) {
+    applyIntent(planAction(timeStep));
+}
+
+AgentIntent BacktestAgent::planAction(Lehmer32_t timeStep) {
+    return planIntent(seed, timeStep, !orders.empty());
+}
+
+AgentIntent BacktestAgent::planIntent(Lehmer32_t seed, Lehmer32_t timeStep, bool hasPendingOrders) {
+    AgentIntent intent;
     Lehmer32_t t_seed = seed + timeStep;
-    rn.setSeed(t_seed);
+    RandomNumber rn(t_seed);
     int actionValue = rn.rndInt(0, 100);
 
-    if (orders.size() == 0) {
-        if (actionValue < MAKE_ORDER_NO_PENDING) {
-            addOrder(generateActionDetails(ActionType::AddOrder));
-        }
+    if (!hasPendingOrders) {
+        intent.hasAction = actionValue < MAKE_ORDER_NO_PENDING;
+        intent.action = ActionType::AddOrder;
     } else {
+        intent.hasAction = true;
         if (actionValue < PENDING_ORDER_ACTIONS[0]) {
-            cancelOrder(*orders.begin());
+            intent.action = ActionType::CancelOrder;
         } else if (actionValue < PENDING_ORDER_ACTIONS[0] + PENDING_ORDER_ACTIONS[1]) {
-            modifyOrder(*orders.begin(), generateActionDetails(ActionType::ModifyOrder));
+            intent.action = ActionType::ModifyOrder;
         } else {
-            addOrder(generateActionDetails(ActionType::AddOrder));
+            intent.action = ActionType::AddOrder;
+        }
+    }
+
+    if (intent.hasAction) {
+        std::size_t draws = 0;
+        switch (intent.action) {
+            case ActionType::AddOrder:
+                draws = 5;
+                break;
+            case ActionType::ModifyOrder:
+                draws = 4;
+                break;
+            case ActionType::CancelOrder:
+                break;
+        }
+        for (std::size_t i = 0; i < draws; ++i) {
+            intent.draws[i] = rn.generate();
         }
     }
+    return intent;
+}
+
+void BacktestAgent::applyIntent(const AgentIntent& intent) {
+    if (!intent.hasAction) {
+        return;
+    }
+
+    switch (intent.action) {
+        case ActionType::AddOrder:
+            addOrder(getActionDetails(intent, cash, holdings, orderbook));
+            break;
+        case ActionType::ModifyOrder:
+            modifyOrder(orders.back(), getActionDetails(intent, cash, holdings, orderbook));
+            break;
+        case ActionType::CancelOrder:
+            cancelOrder(orders.back());
+            break;
+    }
+}
+
+Cash BacktestAgent::getCash() const {
+    return cash;
+}
+
+Holdings BacktestAgent::getHoldings() const {
+    return holdings;
+}
+
+std::size_t BacktestAgent::getNumPendingOrders() const {
+    return orders.size();
 }
 
-Action BacktestAgent::generateActionDetails(ActionType actionType) {
+Action BacktestAgent::getActionDetails(const AgentIntent& intent, Cash cash, Holdings holdings, Orderbook& orderbook) {
     Action action;
-    action.action = actionType;
-    int canBuy = cash / getBestPrice(Side::Buy);
+    action.action = intent.action;
+    int canBuy = cash / getBestPrice(orderbook, Side::Buy);
     int canSell = holdings;
 
-    switch (actionType) {
+    switch (intent.action) {
         case ActionType::AddOrder:
-            action.side = static_cast<Side>(rn.rndInt(0, 1));
-            action.price = getBiasedPrice(action.side);
-            action.quantity = rn.rndInt(1, action.side == Side::Buy ? canBuy * ORDER_SIZE : canSell * ORDER_SIZE);
-            action.orderType = static_cast<OrderType>(rn.rndInt(0, 1));
+            action.side = static_cast<Side>(RandomNumber::toInt(intent.draws[0], 0, 1));
+            action.price = getBiasedPrice(orderbook, action.side, intent.draws[1], intent.draws[2]);
+            action.quantity = RandomNumber::toInt(intent.draws[3], 1, action.side == Side::Buy ? canBuy * ORDER_SIZE : canSell * ORDER_SIZE);
+            action.orderType = static_cast<OrderType>(RandomNumber::toInt(intent.draws[4], 0, 1));
             break;
 
         case ActionType::ModifyOrder:
-            action.side = static_cast<Side>(rn.rndInt(0, 1));
-            action.price = getBiasedPrice(action.side);
-            action.quantity = rn.rndInt(1, action.side == Side::Buy ? canBuy * ORDER_SIZE : canSell * ORDER_SIZE);
+            action.side = static_cast<Side>(RandomNumber::toInt(intent.draws[0], 0, 1));
+            action.price = getBiasedPrice(orderbook, action.side, intent.draws[1], intent.draws[2]);
+            action.quantity = RandomNumber::toInt(intent.draws[3], 1, action.side == Side::Buy ? canBuy * ORDER_SIZE : canSell * ORDER_SIZE);
             break;
 
         case ActionType::CancelOrder:
@@ -86,11 +150,11 @@ Action BacktestAgent::generateActionDetails(ActionType actionType) {
     return action;
 }
 
-Price BacktestAgent::getBiasedPrice(Side side) {
-    Price bestPrice = getBestPrice(side);
-    double bias = (side == Side::Buy ? -1 : 1) * rn.rndDouble(0, BIAS_FACTOR);
+Price BacktestAgent::getBiasedPrice(Orderbook& orderbook, Side side, Lehmer32_t biasDraw, Lehmer32_t oppositeBiasDraw) {
+    Price bestPrice = getBestPrice(orderbook, side);
+    double bias = (side == Side::Buy ? -1 : 1) * RandomNumber::toDouble(biasDraw, 0, BIAS_FACTOR);
 
-    if (rn.rndInt(1, 100) < OPPOSITE_BIAS_CHANCE) {
+    if (RandomNumber::toInt(oppositeBiasDraw, 1, 100) < OPPOSITE_BIAS_CHANCE) {
         bias = -bias;
     }
 
@@ -0,0 +1,118 @@
+#include "OrderEventFile.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+OrderEventFile::OrderEventFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open order event file: " + path);
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < sizeof(OrderEventFileHeader)) {
+        close(fd);
+        throw std::runtime_error("Order event file is too small: " + path);
+    }
+
+    mappingSize = static_cast<std::size_t>(info.st_size);
+    mapping = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps the file alive
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Cannot map order event file: " + path);
+    }
+    // events are read once front to back
+    madvise(mapping, mappingSize, MADV_SEQUENTIAL);
+
+    const auto* header = static_cast<const OrderEventFileHeader*>(mapping);
+    if (std::memcmp(header->magic, ORDER_EVENT_MAGIC, sizeof(ORDER_EVENT_MAGIC)) != 0 || header->version != ORDER_EVENT_VERSION
+        || header->count > (mappingSize - sizeof(OrderEventFileHeader)) / sizeof(OrderEvent)) {
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        throw std::runtime_error("Invalid order event file: " + path);
+    }
+
+    events = reinterpret_cast<const OrderEvent*>(static_cast<const char*>(mapping) + sizeof(OrderEventFileHeader));
+    count = header->count;
+}
+
+OrderEventFile::~OrderEventFile() {
+    if (mapping != nullptr) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+const OrderEvent* OrderEventFile::begin() const {
+    return events;
+}
+
+const OrderEvent* OrderEventFile::end() const {
+    return events + count;
+}
+
+std::size_t OrderEventFile::size() const {
+    return count;
+}
+
+void OrderEventFile::write(const std::string& path, const std::vector<OrderEvent>& events) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open order event file for writing: " + path);
+    }
+
+    OrderEventFileHeader header;
+    std::memcpy(header.magic, ORDER_EVENT_MAGIC, sizeof(ORDER_EVENT_MAGIC));
+    header.version = ORDER_EVENT_VERSION;
+    header.count = events.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(events.data()), static_cast<std::streamsize>(events.size() * sizeof(OrderEvent)));
+    if (!out) {
+        throw std::runtime_error("Cannot write order event file: " + path);
+    }
+}
+
+bool OrderEventFile::parseTextLine(const std::string& line, OrderEvent& event) {
+    std::istringstream iss(line);
+    int flag;
+    double price;
+    int quantity;
+    if (!(iss >> flag >> price >> quantity)) {
+        return false;
+    }
+
+    event = OrderEvent{};
+    event.eventType = OrderEventType::Add;
+    event.side = (flag == 1) ? Side::Buy : Side::Sell;
+    event.orderType = OrderType::LimitOrder;
+    event.price = static_cast<Price>(price);
+    event.quantity = static_cast<Quantity>(quantity);
+    event.orderId = INVALID_ORDER_ID;
+    return true;
+}
+
+std::vector<OrderEvent> OrderEventFile::readText(const std::string& path) {
+    std::ifstream infile(path);
+    if (!infile) {
+        throw std::runtime_error("Cannot open order file: " + path);
+    }
+
+    std::string line;
+    std::vector<OrderEvent> events;
+    OrderEvent event;
+    while (std::getline(infile, line)) {
+        if (!parseTextLine(line, event)) {
+            std::cerr << "error: " << line << std::endl;
+            continue;
+        }
+        events.push_back(event);
+    }
+    return events;
+}
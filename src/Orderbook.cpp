@@ -1,221 +1,697 @@
 #include "Orderbook.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
 
-Orderbook::Orderbook() : orderPool(1000) {}  // Preallocate memory for 1000 Order objects
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::BasicOrderbook(Levels levels)
+    : orderPool(1000), levels(std::move(levels)) {}  // Preallocate memory for 1000 Order objects
 
-void Orderbook::printOrderbook() {
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::printOrderbook() {
     OrderBookLevelInfos orderInfos = getOrderInfos();
 
-    std::cout << "Orderbook State: " << std::endl;
-    std::cout << std::endl;
+    // one flush at the end rather than one per line
+    std::cout << "Orderbook State: \n\n";
 
-    std::cout << "Bid Levels:" << std::endl;
+    std::cout << "Bid Levels:\n";
     for (const auto& level : orderInfos.getBids()) {
-        std::cout << "Price: " << level.price << ", Quantity: " << level.quantity << std::endl;
+        std::cout << "Price: " << level.price << ", Quantity: " << level.quantity << '\n';
     }
 
-    std::cout << "Ask Levels:" << std::endl;
+    std::cout << "Ask Levels:\n";
     for (const auto& level : orderInfos.getAsks()) {
-        std::cout << "Price: " << level.price << ", Quantity: " << level.quantity << std::endl;
+        std::cout << "Price: " << level.price << ", Quantity: " << level.quantity << '\n';
     }
 
     std::cout << std::endl;
 }
 
-OrderConfirmation Orderbook::addOrder(const Price price, const Quantity quantity, const Side side, const OrderType orderType) {
-    OrderPtr order = orderPool.allocate();
-    *order = Order(getOrderId(), price, quantity, side, orderType);
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+OrderConfirmation BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::addOrder(const Price price, const Quantity quantity, const Side side, const OrderType orderType) {
+    Trades trades;
+    OrderId newOrderId = addOrder(price, quantity, side, orderType, trades);
+    if (newOrderId == INVALID_ORDER_ID) {
+        return {};
+    }
+    return OrderConfirmation{newOrderId, std::move(trades)};
+}
 
-    // if we can't match the Market order, return
-    if (order->getOrderType() == OrderType::MarketOrder) {
-        if (!canMatch(order->getSide(), order->getPrice())) {
-            orderPool.deallocate(order); // cleanup
-            return {};
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+OrderId BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::addOrder(const Price price, const Quantity quantity, const Side side, const OrderType orderType, Trades& trades) {
+    [[maybe_unused]] auto latencyScope = instrumentation.add();
+    checkPrice(price, orderType);
+
+    OrderId nextOrderId = getOrderId();
+    journalEvent(JournalRecordType::Add, side, orderType, price, quantity, nextOrderId);
+    OrderId newOrderId = submitOrder(nextOrderId, price, quantity, side, orderType, trades);
+    if (newOrderId == INVALID_ORDER_ID) {
+        journalEvent(JournalRecordType::Reject, side, orderType, price, quantity, nextOrderId);
+    }
+    triggerStops(trades);
+    return newOrderId;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::optional<Price> BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::addOrderBatch(const OrderRequest* requests, std::size_t count, OrderId* orderIds, Trades& trades) {
+    // the whole batch is checked first, so a bad request leaves the book as it was. Every request
+    // but a fill-or-kill is inserted at its own price for the uncross, immediate ones included
+    for (std::size_t i = 0; i < count; i++) {
+        if (requests[i].orderType != OrderType::FillOrKill && !levels.contains(requests[i].price)) {
+            throw std::out_of_range("Price is outside of the book's price band");
         }
     }
 
-    // if the price level doesn't exist, create it
-    if (order->getSide() == Side::Buy && bidLevels.find(order->getPrice()) == bidLevels.end()) {
-        auto q = std::make_shared<Queue>();
-        bidLevels[order->getPrice()] = std::move(q);
-        bids.push(std::make_pair(order->getPrice(), bidLevels[order->getPrice()]));
-    } else if (order->getSide() == Side::Sell && askLevels.find(order->getPrice()) == askLevels.end()) {
-        auto q = std::make_shared<Queue>();
-        askLevels[order->getPrice()] = std::move(q);
-        asks.push(std::make_pair(order->getPrice(), askLevels[order->getPrice()]));
+    // insert the whole batch without matching (the book may be crossed until the uncross)
+    for (std::size_t i = 0; i < count; i++) {
+        const OrderRequest& request = requests[i];
+        if (request.orderType == OrderType::FillOrKill) {
+            // all or nothing has no meaning in a single uncross, so these are rejected (their id is used up)
+            orderIds[i] = INVALID_ORDER_ID;
+            OrderId rejectedOrderId = getOrderId();
+            journalEvent(JournalRecordType::Add, request.side, request.orderType, request.price, request.quantity, rejectedOrderId);
+            journalEvent(JournalRecordType::Reject, request.side, request.orderType, request.price, request.quantity, rejectedOrderId);
+            continue;
+        }
+        orderIds[i] = insertOrder(getOrderId(), request.price, request.quantity, request.side, request.orderType)->getOrderId();
+        journalEvent(JournalRecordType::Add, request.side, request.orderType, request.price, request.quantity, orderIds[i]);
     }
 
-    // add the order to the price level
-    QueuePtr queue = (order->getSide() == Side::Buy) ? bidLevels[order->getPrice()] : askLevels[order->getPrice()];
-    queue->push_back(order);
+    // uncross once, printing every trade at the clearing price
+    std::optional<Price> clearingPrice = getClearingPrice();
+    if (clearingPrice) {
+        matchOrders(trades, Side::Buy, clearingPrice); // every trade prints at the clearing price, whichever side
+    }
 
-    // store order and its location
-    orders[order->getOrderId()] = order;
+    // market and immediate-or-cancel orders never rest, so drop whatever the auction didn't fill
+    for (std::size_t i = 0; i < count; i++) {
+        if (requests[i].orderType == OrderType::MarketOrder || requests[i].orderType == OrderType::ImmediateOrCancel) {
+            cancelOrder(orderIds[i]);
+        }
+    }
 
-    return OrderConfirmation{order->getOrderId(), matchOrders()};
+    triggerStops(trades);
+    return clearingPrice;
 }
 
-void Orderbook::cancelOrder(OrderId orderId) {
-    // if the order doesn't exist, return
-    if (orders.find(orderId) == orders.end()) {
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::cancelOrder(OrderId orderId) {
+    [[maybe_unused]] auto latencyScope = instrumentation.cancel();
+
+    // remove the order from the table (if the order doesn't exist, return)
+    OrderPtr order = orders.take(orderId);
+    if (order == nullptr) {
         return;
     }
 
-    // remove the order from the map
-    auto order = orders[orderId];
-    orders.erase(orderId);
+    journalEvent(JournalRecordType::Cancel, order->getSide(), order->getOrderType(), order->getPrice(), order->getRemainingQuantity(), orderId);
+    removeOrder(order);
+}
 
-    // remove the order from the price level
-    auto& level = (order->getSide() == Side::Buy) ? bidLevels[order->getPrice()] : askLevels[order->getPrice()];
-    auto it = std::find(level->begin(), level->end(), order);
-    if (it != level->end()) {
-        level->erase(it);
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+OrderConfirmation BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::modifyOrder(OrderId orderId, Price price, Quantity quantity, Side side) {
+    Trades trades;
+    OrderId newOrderId = modifyOrder(orderId, price, quantity, side, trades);
+    if (newOrderId == INVALID_ORDER_ID) {
+        return {};
     }
-
-    // not removing the level from the heap if empty,
-    // as it will be removed when it is at top (lazy deletion)
-
-    // deallocate the order
-    orderPool.deallocate(order);
+    return OrderConfirmation{newOrderId, std::move(trades)};
 }
 
-OrderConfirmation Orderbook::modifyOrder(OrderId orderId, Price price, Quantity quantity, Side side) {
-    // if the order doesn't exist, return
-    if (orders.find(orderId) == orders.end()) {
-        return {};
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+OrderId BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::modifyOrder(OrderId orderId, Price price, Quantity quantity, Side side, Trades& trades) {
+    [[maybe_unused]] auto latencyScope = instrumentation.modify();
+
+    // if the order doesn't exist, return (the slot is kept so a requeue doesn't look the id up again)
+    OrderTable::Slot slot = orders.findSlot(orderId);
+    OrderPtr order = slot.get();
+    if (order == nullptr) {
+        return INVALID_ORDER_ID;
     }
 
     // cant change the order type, so this should be stored
-    OrderType orderType = orders[orderId]->getOrderType();
+    OrderType orderType = order->getOrderType();
+    checkPrice(price, orderType);
+
+    // amend down in place: same price and side, smaller (or equal) quantity keeps the id and time
+    // priority, and can't cross the book so there is nothing to match
+    if (price == order->getPrice() && side == order->getSide() && quantity > 0 && quantity <= order->getRemainingQuantity()) {
+        journalEvent(JournalRecordType::Modify, side, orderType, price, quantity, orderId, orderId);
+        if (quantity < order->getRemainingQuantity()) {
+            OrderLevel* level = order->getLevel();
+            level->reduce(order, order->getRemainingQuantity() - quantity);
+            publishLevel(side, *level, LevelUpdateType::Changed);
+        }
+        return orderId;
+    }
+
+    OrderId nextOrderId = getOrderId();
+    journalEvent(JournalRecordType::Modify, side, orderType, price, quantity, orderId, nextOrderId);
 
     // cancel the order
-    cancelOrder(orderId);
+    orders.erase(slot);
+    removeOrder(order);
 
     // add the modified order
-    return addOrder(price, quantity, side, orderType);
+    OrderId newOrderId = submitOrder(nextOrderId, price, quantity, side, orderType, trades);
+    if (newOrderId == INVALID_ORDER_ID) {
+        journalEvent(JournalRecordType::Reject, side, orderType, price, quantity, nextOrderId);
+    }
+    triggerStops(trades);
+    return newOrderId;
 }
 
-std::size_t Orderbook::getNumBids() const {
-    return bids.size();
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::size_t BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getNumBids() const {
+    return levels.size(Side::Buy);
 }
 
-std::size_t Orderbook::getNumAsks() const {
-    return asks.size();
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::size_t BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getNumAsks() const {
+    return levels.size(Side::Sell);
 }
 
-std::size_t Orderbook::getNumOrders() const {
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::size_t BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getNumOrders() const {
     return orders.size();
 }
 
-OrderBookLevelInfos Orderbook::getOrderInfos() const {
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+OrderBookLevelInfos BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getOrderInfos() const {
     LevelInfos bidInfos, askInfos;
 
-    bidInfos.reserve(orders.size());
-    askInfos.reserve(orders.size());
+    bidInfos.reserve(levels.size(Side::Buy));
+    askInfos.reserve(levels.size(Side::Sell));
+
+    levels.forEach(Side::Buy, [&](const OrderLevel& level) {
+        bidInfos.push_back(level.getInfo());
+    });
+
+    levels.forEach(Side::Sell, [&](const OrderLevel& level) {
+        askInfos.push_back(level.getInfo());
+    });
+
+    return OrderBookLevelInfos{bidInfos, askInfos};
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::size_t BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getDepth(Side side, LevelInfo* levelInfos, std::size_t maxLevels) const {
+    return levels.depth(side, levelInfos, maxLevels);
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::uint64_t BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getBandQuantity(Side side, std::size_t ticks) {
+    return levels.bandQuantity(side, ticks);
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+SweepCost BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getSweepCost(Side side, Quantity quantity) {
+    return levels.sweep(side, quantity, noPriceLimit(side));
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::optional<Price> BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getBestBid() {
+    OrderLevel* bestBid = levels.best(Side::Buy);
+    return bestBid == nullptr ? std::nullopt : std::optional<Price>(bestBid->price);
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::optional<Price> BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getBestAsk() {
+    OrderLevel* bestAsk = levels.best(Side::Sell);
+    return bestAsk == nullptr ? std::nullopt : std::optional<Price>(bestAsk->price);
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::optional<Price> BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getSpread() {
+    std::optional<Price> bestBid = getBestBid();
+    std::optional<Price> bestAsk = getBestAsk();
+    if (!bestBid || !bestAsk) {
+        return std::nullopt;
+    }
+    return *bestAsk - *bestBid;
+}
 
-    auto CreateLevelInfos = [](Price price, const QueuePtr& q) {
-        Quantity totalQuantity = 0;
-        for (const auto& order : *q) {
-            totalQuantity += order->getRemainingQuantity();
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::optional<double> BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getMidPrice() {
+    std::optional<Price> bestBid = getBestBid();
+    std::optional<Price> bestAsk = getBestAsk();
+    if (!bestBid || !bestAsk) {
+        return std::nullopt;
+    }
+    return (static_cast<double>(*bestBid) + static_cast<double>(*bestAsk)) / 2.0;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+const PoolStats& BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getPoolStats() const {
+    return orderPool.getStats();
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::saveSnapshot(const std::string& path) const {
+    std::vector<SnapshotOrder> snapshotOrders;
+    snapshotOrders.reserve(orders.size());
+    for (Side side : {Side::Buy, Side::Sell}) {
+        levels.forEach(side, [&](const OrderLevel& level) {
+            for (OrderPtr order : level) {
+                snapshotOrders.push_back(SnapshotOrder{order->getOrderId(), order->getPrice(), order->getInitialQuantity(),
+                    order->getRemainingQuantity(), order->getSide(), order->getOrderType(), {0, 0}});
+            }
+        });
+    }
+
+    BookSnapshotHeader header;
+    std::memcpy(header.magic, BOOK_SNAPSHOT_MAGIC, sizeof(BOOK_SNAPSHOT_MAGIC));
+    header.version = BOOK_SNAPSHOT_VERSION;
+    header.nextOrderId = orderId;
+    header.poolCapacity = orderPool.getStats().capacity;
+    header.orderCount = snapshotOrders.size();
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open snapshot for writing: " + path);
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(snapshotOrders.data()), static_cast<std::streamsize>(snapshotOrders.size() * sizeof(SnapshotOrder)));
+    if (!out) {
+        throw std::runtime_error("Cannot write snapshot: " + path);
+    }
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::loadSnapshot(const std::string& path) {
+    if (!orders.empty()) {
+        throw std::logic_error("A snapshot can only be loaded into an empty book");
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    BookSnapshotHeader header;
+    if (!in || !in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        throw std::runtime_error("Cannot read snapshot: " + path);
+    }
+    if (std::memcmp(header.magic, BOOK_SNAPSHOT_MAGIC, sizeof(BOOK_SNAPSHOT_MAGIC)) != 0 || header.version != BOOK_SNAPSHOT_VERSION) {
+        throw std::runtime_error("Invalid snapshot: " + path);
+    }
+
+    std::vector<SnapshotOrder> snapshotOrders(header.orderCount);
+    if (!in.read(reinterpret_cast<char*>(snapshotOrders.data()), static_cast<std::streamsize>(snapshotOrders.size() * sizeof(SnapshotOrder)))) {
+        throw std::runtime_error("Snapshot is truncated: " + path);
+    }
+
+    // every price is checked before anything is inserted, so a snapshot from an engine without a
+    // price band that doesn't fit this book's band is refused with the book still empty
+    for (const SnapshotOrder& snapshotOrder : snapshotOrders) {
+        if (!levels.contains(snapshotOrder.price)) {
+            throw std::out_of_range("Snapshot order price is outside of the book's price band: " + path);
         }
-        return LevelInfo{price, totalQuantity};
-    };
+    }
 
-    auto HeapToVector = [](const auto& heap) {
-        std::vector<std::pair<Price, QueuePtr>> vec;
-        auto copy = heap;
-        while (!copy.empty()) {
-            vec.push_back(std::make_pair(copy.top().first, copy.top().second));
-            copy.pop();
+    orderPool.reserve(std::max<std::uint64_t>(header.poolCapacity, header.orderCount));
+
+    // orders are in priority order, so appending each to its level restores the queues
+    for (const SnapshotOrder& snapshotOrder : snapshotOrders) {
+        OrderPtr order = orderPool.allocate();
+        *order = Order(snapshotOrder.orderId, snapshotOrder.price, snapshotOrder.initialQuantity, snapshotOrder.side, snapshotOrder.orderType, clock.now());
+        order->fill(snapshotOrder.initialQuantity - snapshotOrder.remainingQuantity);
+        OrderLevel& level = levels.getOrCreate(snapshotOrder.side, snapshotOrder.price);
+        level.push_back(order);
+        levels.update(snapshotOrder.side, level);
+        orders.insert(order);
+    }
+    orderId = header.nextOrderId;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::setJournal(Journal* journal) {
+    this->journal = journal;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::setLevelUpdates(LevelUpdates* levelUpdates) {
+    this->levelUpdates = levelUpdates;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+LevelSnapshot BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getLevelSnapshot() const {
+    LevelSnapshot snapshot{sequence, {}, {}};
+    snapshot.bids.reserve(levels.size(Side::Buy));
+    snapshot.asks.reserve(levels.size(Side::Sell));
+
+    // the heap index can still hold emptied levels, these are not part of the depth
+    levels.forEach(Side::Buy, [&](const OrderLevel& level) {
+        if (!level.empty()) {
+            snapshot.bids.push_back(level.getInfo());
         }
-        return vec;
-    };
+    });
+    levels.forEach(Side::Sell, [&](const OrderLevel& level) {
+        if (!level.empty()) {
+            snapshot.asks.push_back(level.getInfo());
+        }
+    });
+    return snapshot;
+}
 
-    auto bidVec = HeapToVector(bids);
-    auto askVec = HeapToVector(asks);
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+Clock& BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getClock() {
+    return clock;
+}
 
-    for (const auto& [price, q] : bidVec) {
-        bidInfos.push_back(CreateLevelInfos(price, q));
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::optional<Time> BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getOrderTime(OrderId orderId) const {
+    OrderPtr order = orders.find(orderId);
+    if (order == nullptr) {
+        return std::nullopt;
     }
+    return order->getTime();
+}
 
-    for (const auto& [price, q] : askVec) {
-        askInfos.push_back(CreateLevelInfos(price, q));
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+TradeSink& BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getTradeSink() {
+    return tradeSink;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+const Instrumentation& BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getInstrumentation() const {
+    return instrumentation;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+StopId BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::addStopOrder(Price triggerPrice, Quantity quantity, Side side, Trades& trades) {
+    // a stop has no price limit once triggered: it takes whatever the opposite side has and drops the rest
+    Price limitPrice = (side == Side::Buy) ? std::numeric_limits<Price>::max() : std::numeric_limits<Price>::min();
+    return addStop(StopOrder{stopId++, triggerPrice, limitPrice, quantity, side, OrderType::ImmediateOrCancel}, trades);
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+StopId BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::addStopLimitOrder(Price triggerPrice, Price limitPrice, Quantity quantity, Side side, Trades& trades) {
+    checkPrice(limitPrice, OrderType::LimitOrder); // checked now, not when the stop fires mid-cascade
+    return addStop(StopOrder{stopId++, triggerPrice, limitPrice, quantity, side, OrderType::LimitOrder}, trades);
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+bool BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::cancelStopOrder(StopId stopId) {
+    if (!stops.cancel(stopId)) {
+        return false;
     }
+    journalEvent(JournalRecordType::StopCancel, Side::Buy, OrderType::LimitOrder, 0, 0, stopId);
+    return true;
+}
 
-    return OrderBookLevelInfos{bidInfos, askInfos};
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::size_t BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getNumStops() const {
+    return stops.size();
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::setStopTriggers(StopTriggers* stopTriggers) {
+    this->stopTriggers = stopTriggers;
 }
 
-int Orderbook::getOrderId() {
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+int BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getOrderId() {
     return orderId++;
 }
 
-bool Orderbook::canMatch(Side side, Price price) const {
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::checkPrice(Price price, OrderType orderType) const {
+    // immediate orders never rest, so only orders that can rest need a level at their price
+    if (!isImmediate(orderType) && !levels.contains(price)) {
+        throw std::out_of_range("Price is outside of the book's price band");
+    }
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+bool BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::canMatch(Side side, Price price) {
     if (side == Side::Buy) {
         // if there are no asks, we can't match
         // if the price is less than the best ask, we can't match
-        return !asks.empty() && price >= asks.top().first;
+        OrderLevel* bestAsk = levels.best(Side::Sell);
+        return bestAsk != nullptr && price >= bestAsk->price;
     } else {
         // if there are no bids, we can't match
         // if the price is greater than the best bid, we can't match
-        return !bids.empty() && price <= bids.top().first;
+        OrderLevel* bestBid = levels.best(Side::Buy);
+        return bestBid != nullptr && price <= bestBid->price;
     }
 }
 
-Trades Orderbook::matchOrders() {
-    Trades trades;
-    trades.reserve(asks.size() + bids.size()); // At most, we can have one trade per order
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+OrderId BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::submitOrder(const OrderId newOrderId, const Price price, const Quantity quantity, const Side side, const OrderType orderType, Trades& trades) {
+    // immediate orders are matched straight off the opposite side, they never rest
+    if (isImmediate(orderType)) {
+        return takeLiquidity(newOrderId, price, quantity, side, orderType, trades);
+    }
 
-    // handle lazy deletion of levels (if they are empty)
-    while (!bids.empty() && bidLevels[bids.top().first]->empty()) {
-        bidLevels.erase(bids.top().first);
-        bids.pop();
+    // if we can't match the Market order, return (the rejected order still uses up its id)
+    if (orderType == OrderType::MarketOrder && !canMatch(side, price)) {
+        return INVALID_ORDER_ID;
     }
-    while (!asks.empty() && askLevels[asks.top().first]->empty()) {
-        askLevels.erase(asks.top().first);
-        asks.pop();
+
+    insertOrder(newOrderId, price, quantity, side, orderType);
+    matchOrders(trades, side);
+    return newOrderId;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+OrderId BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::takeLiquidity(const OrderId newOrderId, const Price price, const Quantity quantity, const Side side, const OrderType orderType, Trades& trades) {
+    Side restingSide = (side == Side::Buy) ? Side::Sell : Side::Buy;
+    auto crosses = [side, price](Price restingPrice) {
+        return (side == Side::Buy) ? restingPrice <= price : restingPrice >= price;
+    };
+
+    // fill-or-kill is decided from the level aggregates, before any fill is applied. One that can't
+    // even reach the best level is rejected from the touch, and the sweep stops at its limit price
+    if (orderType == OrderType::FillOrKill) {
+        OrderLevel* bestLevel = levels.best(restingSide);
+        if (bestLevel == nullptr || !crosses(bestLevel->price)) {
+            return INVALID_ORDER_ID;
+        }
+        SweepCost cost = levels.sweep(restingSide, quantity, price);
+        if (cost.quantity < quantity) {
+            return INVALID_ORDER_ID;
+        }
     }
 
-    while (!bids.empty() && !asks.empty()) {
-        Price bidPrice = bids.top().first;
-        auto& bidLevel = bids.top().second;
-        if (bidLevel->empty()) {
-            bids.pop();
-            bidLevels.erase(bidPrice);
-            continue;
+    [[maybe_unused]] auto latencyScope = instrumentation.match();
+
+    // level filled but not emptied yet, published once matching stops (fills are coalesced)
+    OrderLevel* changedLevel = nullptr;
+    Quantity remaining = quantity;
+    while (remaining > 0) {
+        OrderLevel* level = levels.best(restingSide);
+        if (level == nullptr || !crosses(level->price)) {
+            break;
         }
-        OrderPtr topBid = bidLevel->front();
 
-        Price askPrice = asks.top().first;
-        auto& askLevel = asks.top().second;
-        if (askLevel->empty()) {
-            asks.pop();
-            askLevels.erase(askPrice);
-            continue;
+        OrderPtr resting = level->front();
+        Quantity tradeQuantity = std::min(remaining, resting->getRemainingQuantity());
+        level->fill(resting, tradeQuantity);
+        remaining -= tradeQuantity;
+        changedLevel = level;
+
+        // both legs print at the resting order's price (an order with no limit never shows its price)
+        TradeInfo incomingTrade{newOrderId, resting->getPrice(), tradeQuantity};
+        TradeInfo restingTrade{resting->getOrderId(), resting->getPrice(), tradeQuantity};
+        recordTrade(resting->getPrice());
+        const TradeInfo& bidTrade = (side == Side::Buy) ? incomingTrade : restingTrade;
+        const TradeInfo& askTrade = (side == Side::Buy) ? restingTrade : incomingTrade;
+        trades.push_back(Trade{bidTrade, askTrade});
+        tradeSink.onTrade(bidTrade, askTrade);
+        if (journal != nullptr) {
+            OrderType bidOrderType = (side == Side::Buy) ? orderType : resting->getOrderType();
+            journal->append(JournalRecord{JournalRecordType::Trade, Side::Buy, bidOrderType, 0,
+                bidTrade.price, tradeQuantity, askTrade.price, bidTrade.orderId, askTrade.orderId});
+        }
+
+        // if the resting order is fully filled, remove it from the level
+        if (resting->getRemainingQuantity() == 0) {
+            level->pop_front();
+            if (level->empty()) {
+                publishLevel(restingSide, *level, LevelUpdateType::Deleted);
+                changedLevel = nullptr;
+                levels.popBest(restingSide);
+            }
+            orders.erase(resting->getOrderId());
+            orderPool.deallocate(resting);
+        }
+    }
+
+    if (changedLevel != nullptr) {
+        publishLevel(restingSide, *changedLevel, LevelUpdateType::Changed);
+    }
+
+    // nothing filled, so nothing happened: the order is rejected
+    return remaining == quantity ? INVALID_ORDER_ID : newOrderId;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::removeOrder(OrderPtr order) {
+    // unlink the order from its price level
+    OrderLevel* level = order->getLevel();
+    level->erase(order);
+
+    // let the level index drop the level if it is now empty
+    if (level->empty()) {
+        publishLevel(order->getSide(), *level, LevelUpdateType::Deleted);
+        levels.release(order->getSide(), *level);
+    } else {
+        publishLevel(order->getSide(), *level, LevelUpdateType::Changed);
+    }
+
+    // deallocate the order
+    orderPool.deallocate(order);
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+OrderPtr BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::insertOrder(const OrderId newOrderId, const Price price, const Quantity quantity, const Side side, const OrderType orderType) {
+    OrderPtr order = orderPool.allocate();
+    *order = Order(newOrderId, price, quantity, side, orderType, clock.now());
+
+    // add the order to the price level (creating the level if it doesn't exist)
+    OrderLevel& level = levels.getOrCreate(side, price);
+    LevelUpdateType updateType = level.empty() ? LevelUpdateType::Added : LevelUpdateType::Changed;
+    level.push_back(order);
+    publishLevel(side, level, updateType);
+
+    // store order and its location
+    orders.insert(order);
+    return order;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+std::optional<Price> BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::getClearingPrice() {
+    OrderLevel* bestBid = levels.best(Side::Buy);
+    OrderLevel* bestAsk = levels.best(Side::Sell);
+    if (bestBid == nullptr || bestAsk == nullptr || bestBid->price < bestAsk->price) {
+        return std::nullopt;
+    }
+
+    // only levels inside the crossed range [best ask, best bid] can trade
+    const Price low = bestAsk->price;
+    const Price high = bestBid->price;
+    auctionBids.clear();
+    auctionAsks.clear();
+    levels.forEachWithin(Side::Buy, low, [&](const OrderLevel& level) {
+        auctionBids.push_back(level.getInfo());
+    });
+    levels.forEachWithin(Side::Sell, high, [&](const OrderLevel& level) {
+        auctionAsks.push_back(level.getInfo());
+    });
+
+    // bids in descending and asks in ascending price (the heap index visits them unordered)
+    std::sort(auctionBids.begin(), auctionBids.end(), [](const LevelInfo& lhs, const LevelInfo& rhs) { return lhs.price > rhs.price; });
+    std::sort(auctionAsks.begin(), auctionAsks.end(), [](const LevelInfo& lhs, const LevelInfo& rhs) { return lhs.price < rhs.price; });
+
+    // demand(p) = bid quantity priced >= p, supply(p) = ask quantity priced <= p
+    std::uint64_t demand = 0;
+    for (const LevelInfo& bid : auctionBids) {
+        demand += bid.quantity;
+    }
+    std::uint64_t supply = 0;
+
+    // walk every candidate price in ascending order, keeping the best range of prices
+    std::uint64_t bestVolume = 0;
+    std::uint64_t bestImbalance = 0;
+    Price bestLow = low;
+    Price bestHigh = low;
+    std::size_t bidIndex = auctionBids.size();
+    std::size_t askIndex = 0;
+    while (bidIndex > 0 || askIndex < auctionAsks.size()) {
+        Price price = high;
+        if (bidIndex > 0) {
+            price = std::min(price, auctionBids[bidIndex - 1].price);
+        }
+        if (askIndex < auctionAsks.size()) {
+            price = std::min(price, auctionAsks[askIndex].price);
+        }
+
+        while (askIndex < auctionAsks.size() && auctionAsks[askIndex].price <= price) {
+            supply += auctionAsks[askIndex++].quantity;
+        }
+
+        std::uint64_t volume = std::min(demand, supply);
+        std::uint64_t imbalance = demand > supply ? demand - supply : supply - demand;
+        if (volume > bestVolume || (volume == bestVolume && imbalance < bestImbalance)) {
+            bestVolume = volume;
+            bestImbalance = imbalance;
+            bestLow = price;
+            bestHigh = price;
+        } else if (volume == bestVolume && imbalance == bestImbalance) {
+            bestHigh = price;
+        }
+        // bids at this price count towards this candidate only, drop them for the next one
+        if (bidIndex > 0 && auctionBids[bidIndex - 1].price == price) {
+            demand -= auctionBids[--bidIndex].quantity;
+        }
+    }
+
+    return bestLow + (bestHigh - bestLow) / 2;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::journalEvent(JournalRecordType recordType, Side side, OrderType orderType, Price price, Quantity quantity, OrderId orderId, OrderId otherOrderId) {
+    if (journal != nullptr) {
+        journal->append(JournalRecord{recordType, side, orderType, 0, price, quantity, 0, orderId, otherOrderId});
+    }
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::publishLevel(Side side, const OrderLevel& level, LevelUpdateType type) {
+    // every level change comes through here, so the level index's packed quantities are kept in step too
+    levels.update(side, level);
+    if (levelUpdates != nullptr) {
+        levelUpdates->push_back(LevelUpdate{++sequence, side, type, level.price, level.totalQuantity, level.orderCount});
+    }
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::matchOrders(Trades& trades, Side incomingSide, std::optional<Price> tradePrice) {
+    [[maybe_unused]] auto latencyScope = instrumentation.match();
+
+    // levels filled but not emptied yet, published once matching stops (fills are coalesced)
+    OrderLevel* changedBid = nullptr;
+    OrderLevel* changedAsk = nullptr;
+
+    while (true) {
+        // best levels (the heap index also drops empty levels here)
+        OrderLevel* bidLevel = levels.best(Side::Buy);
+        OrderLevel* askLevel = levels.best(Side::Sell);
+        if (bidLevel == nullptr || askLevel == nullptr) {
+            break;
         }
-        OrderPtr topAsk = askLevel->front();
 
         // if the bid price is less than the ask price, we can't match
-        if (bidPrice < askPrice) {
+        if (bidLevel->price < askLevel->price) {
             break;
         }
 
-        Quantity tradeQuantity = std::min(topBid->getRemainingQuantity(), topAsk->getRemainingQuantity());
-        topBid->fill(tradeQuantity);
-        topAsk->fill(tradeQuantity);
+        OrderPtr topBid = bidLevel->front();
+        OrderPtr topAsk = askLevel->front();
 
-        trades.push_back(
-            Trade{
-                TradeInfo{topBid->getOrderId(), topBid->getPrice(), tradeQuantity},
-                TradeInfo{topAsk->getOrderId(), topAsk->getPrice(), tradeQuantity}
-            }
-        );
+        Quantity tradeQuantity = std::min(topBid->getRemainingQuantity(), topAsk->getRemainingQuantity());
+        bidLevel->fill(topBid, tradeQuantity);
+        askLevel->fill(topAsk, tradeQuantity);
+        changedBid = bidLevel;
+        changedAsk = askLevel;
+
+        TradeInfo bidTrade{topBid->getOrderId(), tradePrice.value_or(topBid->getPrice()), tradeQuantity};
+        TradeInfo askTrade{topAsk->getOrderId(), tradePrice.value_or(topAsk->getPrice()), tradeQuantity};
+        trades.push_back(Trade{bidTrade, askTrade});
+        tradeSink.onTrade(bidTrade, askTrade);
+        recordTrade(tradePrice.value_or(incomingSide == Side::Buy ? topAsk->getPrice() : topBid->getPrice()));
+        if (journal != nullptr) {
+            journal->append(JournalRecord{JournalRecordType::Trade, Side::Buy, topBid->getOrderType(), 0,
+                bidTrade.price, tradeQuantity, askTrade.price, bidTrade.orderId, askTrade.orderId});
+        }
 
         // if the order is fully filled, remove it from the level
         if (topAsk->getRemainingQuantity() == 0) {
             askLevel->pop_front();
             if (askLevel->empty()) {
-                asks.pop();
-                askLevels.erase(topAsk->getPrice());
+                publishLevel(Side::Sell, *askLevel, LevelUpdateType::Deleted);
+                changedAsk = nullptr;
+                levels.popBest(Side::Sell);
             }
             orders.erase(topAsk->getOrderId());
             orderPool.deallocate(topAsk);
@@ -224,12 +700,87 @@ Trades Orderbook::matchOrders() {
         if (topBid->getRemainingQuantity() == 0) {
             bidLevel->pop_front();
             if (bidLevel->empty()) {
-                bids.pop();
-                bidLevels.erase(topBid->getPrice());
+                publishLevel(Side::Buy, *bidLevel, LevelUpdateType::Deleted);
+                changedBid = nullptr;
+                levels.popBest(Side::Buy);
             }
             orders.erase(topBid->getOrderId());
             orderPool.deallocate(topBid);
         }
     }
-    return trades;
-}
\ No newline at end of file
+
+    if (changedBid != nullptr) {
+        publishLevel(Side::Buy, *changedBid, LevelUpdateType::Changed);
+    }
+    if (changedAsk != nullptr) {
+        publishLevel(Side::Sell, *changedAsk, LevelUpdateType::Changed);
+    }
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::recordTrade(Price price) {
+    lastTradePrice = price;
+    tradeLow = std::min(tradeLow, price);
+    tradeHigh = std::max(tradeHigh, price);
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+StopId BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::addStop(const StopOrder& stop, Trades& trades) {
+    if (journal != nullptr) {
+        journal->append(JournalRecord{JournalRecordType::Stop, stop.side, stop.orderType, 0, stop.limitPrice, stop.quantity,
+                                      stop.triggerPrice, stop.stopId, INVALID_ORDER_ID});
+    }
+    stops.add(stop);
+
+    // a stop the market has already traded through fires straight away
+    if (lastTradePrice && (stop.side == Side::Buy ? *lastTradePrice >= stop.triggerPrice : *lastTradePrice <= stop.triggerPrice)) {
+        recordTrade(*lastTradePrice);
+        triggerStops(trades);
+    }
+    return stop.stopId;
+}
+
+template<typename Levels, typename Clock, typename Allocator, typename TradeSink, typename Instrumentation>
+void BasicOrderbook<Levels, Clock, Allocator, TradeSink, Instrumentation>::triggerStops(Trades& trades) {
+    // each injected stop's trades widen the traded range, which can trigger more stops (a cascade)
+    while (true) {
+        if (tradeLow <= tradeHigh) {
+            if (!stops.empty()) {
+                stops.trigger(tradeLow, tradeHigh, triggeredStops);
+            }
+            tradeLow = std::numeric_limits<Price>::max();
+            tradeHigh = std::numeric_limits<Price>::min();
+        }
+        if (triggeredStops.empty()) {
+            return;
+        }
+
+        StopOrder stop = triggeredStops.front();
+        triggeredStops.pop_front();
+        OrderId nextOrderId = getOrderId();
+        journalEvent(JournalRecordType::Add, stop.side, stop.orderType, stop.limitPrice, stop.quantity, nextOrderId);
+        if (submitOrder(nextOrderId, stop.limitPrice, stop.quantity, stop.side, stop.orderType, trades) == INVALID_ORDER_ID) {
+            journalEvent(JournalRecordType::Reject, stop.side, stop.orderType, stop.limitPrice, stop.quantity, nextOrderId);
+        }
+        if (stopTriggers != nullptr) {
+            stopTriggers->push_back(StopTrigger{stop.stopId, nextOrderId});
+        }
+    }
+}
+
+// default engines
+template class BasicOrderbook<HeapLevels>;
+template class BasicOrderbook<LadderLevels>;
+template class BasicOrderbook<TreeLevels>;
+
+// other time sources
+template class BasicOrderbook<HeapLevels, TscClock>;
+template class BasicOrderbook<HeapLevels, SimulationClock>;
+template class BasicOrderbook<LadderLevels, TscClock>;
+template class BasicOrderbook<LadderLevels, SimulationClock>;
+
+// per-order heap allocations
+template class BasicOrderbook<HeapLevels, SequenceClock, MemoryPool<Order>>;
+
+// fully instrumented ladder (wall clock timestamps, trade counts and latency histograms)
+template class BasicOrderbook<LadderLevels, TscClock, SlabPool<Order>, TradeCounter, LatencyInstrumentation>;
@@ -1,35 +1,60 @@
 #include <iostream>
+#include <string>
 #include "Orderbook.h"
 #include "BacktestAgent.h"
+#include "AgentSimulation.h"
+#include "AgentPopulation.h"
 
 const int NUMBER_OF_AGENTS = 1000;
 RandomNumber rn = RandomNumber();
 const int SEED = 1234;
 const int TICKS_IN_DAY = 100; // number of actions in a day
 
-int main() {
+/*
+ * Usage: agent [threads | population [agents]]
+ * With more than one thread, agents plan their actions in parallel (same results as serial).
+ * "population" runs the agents as an AgentPopulation (same results as serial, for large populations).
+ */
+int main(int argc, char* argv[]) {
     Orderbook orderbook = Orderbook();
     rn.setSeed(SEED);
-    
+    bool usePopulation = argc > 1 && std::string(argv[1]) == "population";
+    std::size_t threads = (argc > 1 && !usePopulation) ? std::stoul(argv[1]) : 1;
+    std::size_t numberOfAgents = (usePopulation && argc > 2) ? std::stoul(argv[2]) : NUMBER_OF_AGENTS;
+
     std::vector<BacktestAgent> agents;
-    for (int i = 0; i < NUMBER_OF_AGENTS; i++) {
-        BacktestAgent agent = BacktestAgent(rn.rndInt(1, 10000), orderbook);
-        agents.push_back(agent);
+    AgentPopulation population(orderbook);
+    if (usePopulation) {
+        population.reserve(numberOfAgents);
+        for (std::size_t i = 0; i < numberOfAgents; i++) {
+            population.addAgent(rn.rndInt(1, 10000));
+        }
+    } else {
+        for (std::size_t i = 0; i < numberOfAgents; i++) {
+            BacktestAgent agent = BacktestAgent(rn.rndInt(1, 10000), orderbook);
+            agents.push_back(agent);
+        }
     }
+    AgentSimulation simulation(agents, threads);
 
     std::cout << "Enter number of days to stream: " << std::endl;
     int days;
     std::cin >> days;
 
     for (int i = 0; i < days * TICKS_IN_DAY; i++) {
-        for (auto& agent : agents) {
-            agent.generateAction(i);
+        if (usePopulation) {
+            population.step(i);
+        } else {
+            simulation.step(i);
         }
 
         if (i % TICKS_IN_DAY == 0) {
             orderbook.printOrderbook();
         }
     }
-    
+
+#ifdef ORDERBOOK_LATENCY
+    printLatencyReport(orderbook.getInstrumentation().getLatency(), "Orderbook");
+#endif
     return 0;
-}
\ No newline at end of file
+}
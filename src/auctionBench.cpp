@@ -0,0 +1,91 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include "Orderbook.h"
+#include "RandomNumber.h"
+
+const int AUCTION_ORDERS = 1000000;
+const std::vector<int> BATCH_SIZES = {10, 100, 1000, 10000};
+const Price AUCTION_MID_PRICE = 1000;
+const Price AUCTION_PRICE_RANGE = 10;
+
+/*
+ * Random limit orders around a mid price (both sides overlap, so batches cross)
+ */
+std::vector<OrderRequest> makeRequests() {
+    RandomNumber rn(1234);
+    std::vector<OrderRequest> requests;
+    requests.reserve(AUCTION_ORDERS);
+    for (int i = 0; i < AUCTION_ORDERS; i++) {
+        Side side = rn.rndInt(0, 1) == 0 ? Side::Buy : Side::Sell;
+        Price price = rn.rndInt(AUCTION_MID_PRICE - AUCTION_PRICE_RANGE, AUCTION_MID_PRICE + AUCTION_PRICE_RANGE);
+        Quantity quantity = rn.rndInt(1, 100);
+        requests.push_back(OrderRequest{price, quantity, side, OrderType::LimitOrder});
+    }
+    return requests;
+}
+
+/*
+ * Average ns per order when every order is added (and matched) one by one
+ */
+template<typename Book>
+double continuousLatency(const std::vector<OrderRequest>& requests, std::size_t& numTrades) {
+    Book orderbook;
+    Trades trades;
+    numTrades = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const OrderRequest& request : requests) {
+        trades.clear();
+        orderbook.addOrder(request.price, request.quantity, request.side, request.orderType, trades);
+        numTrades += trades.size();
+    }
+    std::chrono::nanoseconds total = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(total.count()) / requests.size();
+}
+
+/*
+ * Average ns per order when the orders are submitted in call auction batches
+ */
+template<typename Book>
+double auctionLatency(const std::vector<OrderRequest>& requests, std::size_t batchSize, std::size_t& numTrades) {
+    Book orderbook;
+    Trades trades;
+    std::vector<OrderId> orderIds(batchSize);
+    numTrades = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < requests.size(); i += batchSize) {
+        std::size_t count = std::min(batchSize, requests.size() - i);
+        trades.clear();
+        orderbook.addOrderBatch(&requests[i], count, orderIds.data(), trades);
+        numTrades += trades.size();
+    }
+    std::chrono::nanoseconds total = std::chrono::steady_clock::now() - start;
+    return static_cast<double>(total.count()) / requests.size();
+}
+
+/*
+ * Benchmark call auction batches against submitting the same orders one by one
+ */
+int main() {
+    std::vector<OrderRequest> requests = makeRequests();
+    std::size_t heapTrades, ladderTrades;
+
+    double heapContinuous = continuousLatency<Orderbook>(requests, heapTrades);
+    double ladderContinuous = continuousLatency<LadderOrderbook>(requests, ladderTrades);
+    std::cout << "Continuous: heap " << heapContinuous << " ns/order, ladder " << ladderContinuous
+              << " ns/order, " << heapTrades << " trades" << std::endl;
+
+    std::cout << "Batch size, Heap engine auction (ns/order), Ladder engine auction (ns/order), Trades" << std::endl;
+    for (int batchSize : BATCH_SIZES) {
+        double heapAuction = auctionLatency<Orderbook>(requests, batchSize, heapTrades);
+        double ladderAuction = auctionLatency<LadderOrderbook>(requests, batchSize, ladderTrades);
+        if (heapTrades != ladderTrades) {
+            std::cerr << "error: engines produced different trades" << std::endl;
+            return 1;
+        }
+        std::cout << batchSize << ", " << heapAuction << ", " << ladderAuction << ", " << heapTrades << std::endl;
+    }
+    return 0;
+}
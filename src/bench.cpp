@@ -0,0 +1,421 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Orderbook.h"
+#include "BacktestAgent.h"
+#include "AgentPopulation.h"
+#include "AgentSimulation.h"
+#include "LatencyHistogram.h"
+#include "RandomNumber.h"
+
+// BENCH SETTINGS
+const std::vector<int> BOOK_DEPTHS = {100, 10000};  // resting orders per side
+const std::vector<int> PRICE_SPREADS = {10, 1000};  // ticks each side of the book spans
+const int BENCH_OPERATIONS = 100000;
+const int SWEEP_OPERATIONS = 20000;
+const std::size_t SWEEP_LEVELS = 5;                  // levels taken out by each sweep
+const std::size_t SNAPSHOT_LEVELS = 10;              // levels read per side by each snapshot
+const std::vector<int> KERNEL_LEVELS = {100, 1000, 10000}; // ticks summed/swept by the depth kernels
+const int BENCH_AGENTS = 1000;
+const int BENCH_AGENT_TICKS = 200;
+const Price BENCH_MID_PRICE = 30000;                 // inside the default ladder band
+const Lehmer32_t BENCH_SEED = 1234;
+
+// other policy specialisations benchmarked next to the default engines
+using MemoryPoolOrderbook = BasicOrderbook<HeapLevels, SequenceClock, MemoryPool<Order>>;
+using InstrumentedLadderOrderbook = BasicOrderbook<LadderLevels, TscClock, SlabPool<Order>, TradeCounter, LatencyInstrumentation>;
+
+/*
+ * Timing of one workload: a histogram of ns per operation and the total time
+ */
+struct BenchResult {
+    std::string workload;
+    std::string engine;
+    int depth;
+    int spread;
+    LatencyHistogram histogram; // in cycles
+    std::uint64_t totalCycles = 0;
+
+    template<typename Fn>
+    void time(Fn fn) {
+        std::uint64_t start = readCycleCounter();
+        fn();
+        std::uint64_t cycles = readCycleCounter() - start;
+        histogram.record(cycles);
+        totalCycles += cycles;
+    }
+};
+
+/*
+ * A book with depth resting orders per side, spread over spread ticks either side of the mid price
+ */
+template<typename Book>
+struct BenchBook {
+    Book orderbook;
+    RandomNumber rn{BENCH_SEED};
+    int spread;
+    std::vector<OrderId> resting; // ids of the prefilled orders (kept up to date by the workloads)
+    std::vector<Side> restingSides;
+    std::vector<Price> restingPrices;
+    Price lastPrice = 0; // price of the last order added
+    Trades trades;
+
+    BenchBook(int depth, int spread) : spread(spread) {
+        for (int i = 0; i < depth; i++) {
+            for (Side side : {Side::Buy, Side::Sell}) {
+                resting.push_back(add(side));
+                restingSides.push_back(side);
+                restingPrices.push_back(lastPrice);
+            }
+        }
+    }
+
+    // a random price on a side that never crosses the book
+    Price restingPrice(Side side) {
+        Price offset = 1 + rn.rndInt(0, spread - 1);
+        return side == Side::Buy ? BENCH_MID_PRICE - offset : BENCH_MID_PRICE + offset;
+    }
+
+    OrderId add(Side side) {
+        trades.clear();
+        lastPrice = restingPrice(side);
+        return orderbook.addOrder(lastPrice, rn.rndInt(1, 100), side, OrderType::LimitOrder, trades);
+    }
+};
+
+/*
+ * Add a resting order (cancelled again untimed, so the book keeps its depth)
+ */
+template<typename Book>
+void deepInsert(BenchBook<Book>& book, BenchResult& result) {
+    for (int i = 0; i < BENCH_OPERATIONS; i++) {
+        Side side = (i % 2 == 0) ? Side::Buy : Side::Sell;
+        OrderId orderId;
+        result.time([&] { orderId = book.add(side); });
+        book.orderbook.cancelOrder(orderId);
+    }
+}
+
+/*
+ * Cancel a random resting order and add a replacement on the same side
+ */
+template<typename Book>
+void cancelChurn(BenchBook<Book>& book, BenchResult& result) {
+    for (int i = 0; i < BENCH_OPERATIONS; i++) {
+        std::size_t index = book.rn.rndInt(0, static_cast<int>(book.resting.size()) - 1);
+        result.time([&] {
+            book.orderbook.cancelOrder(book.resting[index]);
+            book.resting[index] = book.add(book.restingSides[index]);
+        });
+        book.restingPrices[index] = book.lastPrice;
+    }
+}
+
+/*
+ * A marketable order that takes out the best SWEEP_LEVELS levels of a side (refilled untimed)
+ */
+template<typename Book>
+void sweep(BenchBook<Book>& book, BenchResult& result) {
+    LevelInfo swept[SWEEP_LEVELS];
+    for (int i = 0; i < SWEEP_OPERATIONS; i++) {
+        Side side = (i % 2 == 0) ? Side::Buy : Side::Sell;
+        Side restingSide = (side == Side::Buy) ? Side::Sell : Side::Buy;
+        std::size_t count = book.orderbook.getDepth(restingSide, swept, SWEEP_LEVELS);
+        if (count == 0) {
+            continue;
+        }
+
+        Quantity quantity = 0;
+        for (std::size_t j = 0; j < count; j++) {
+            quantity += swept[j].quantity;
+        }
+        book.trades.clear();
+        result.time([&] { book.orderbook.addOrder(swept[count - 1].price, quantity, side, OrderType::LimitOrder, book.trades); });
+
+        // put the same number of orders back on each level
+        for (std::size_t j = 0; j < count; j++) {
+            Quantity perOrder = swept[j].quantity / swept[j].orderCount;
+            for (std::uint32_t k = 0; k < swept[j].orderCount; k++) {
+                Quantity orderQuantity = (k == 0) ? swept[j].quantity - perOrder * (swept[j].orderCount - 1) : perOrder;
+                book.trades.clear();
+                book.orderbook.addOrder(swept[j].price, orderQuantity, restingSide, OrderType::LimitOrder, book.trades);
+            }
+        }
+    }
+}
+
+/*
+ * Move a random resting order to a new price and quantity on the same side
+ */
+template<typename Book>
+void modifyStorm(BenchBook<Book>& book, BenchResult& result) {
+    for (int i = 0; i < BENCH_OPERATIONS; i++) {
+        std::size_t index = book.rn.rndInt(0, static_cast<int>(book.resting.size()) - 1);
+        Side side = book.restingSides[index];
+        Price price = book.restingPrice(side);
+        Quantity quantity = book.rn.rndInt(1, 100);
+        book.trades.clear();
+        result.time([&] { book.resting[index] = book.orderbook.modifyOrder(book.resting[index], price, quantity, side, book.trades); });
+        book.restingPrices[index] = price;
+    }
+}
+
+/*
+ * Amend a random resting order down at its price (in place), then back up untimed (requeued)
+ */
+template<typename Book>
+void amendDown(BenchBook<Book>& book, BenchResult& result) {
+    for (int i = 0; i < BENCH_OPERATIONS; i++) {
+        std::size_t index = book.rn.rndInt(0, static_cast<int>(book.resting.size()) - 1);
+        Side side = book.restingSides[index];
+        Price price = book.restingPrices[index];
+        book.trades.clear();
+        result.time([&] { book.orderbook.modifyOrder(book.resting[index], price, 1, side, book.trades); });
+        book.resting[index] = book.orderbook.modifyOrder(book.resting[index], price, 100, side, book.trades);
+    }
+}
+
+/*
+ * Read the top SNAPSHOT_LEVELS levels of both sides
+ */
+template<typename Book>
+void depthSnapshot(BenchBook<Book>& book, BenchResult& result) {
+    LevelInfo bids[SNAPSHOT_LEVELS];
+    LevelInfo asks[SNAPSHOT_LEVELS];
+    for (int i = 0; i < BENCH_OPERATIONS; i++) {
+        result.time([&] {
+            book.orderbook.getDepth(Side::Buy, bids, SNAPSHOT_LEVELS);
+            book.orderbook.getDepth(Side::Sell, asks, SNAPSHOT_LEVELS);
+        });
+    }
+}
+
+/*
+ * Total quantity within spread ticks of the touch, alternating sides
+ */
+template<typename Book>
+void bandQuantity(BenchBook<Book>& book, BenchResult& result) {
+    std::uint64_t total = 0;
+    for (int i = 0; i < BENCH_OPERATIONS; i++) {
+        Side side = (i % 2 == 0) ? Side::Buy : Side::Sell;
+        result.time([&] { total += book.orderbook.getBandQuantity(side, static_cast<std::size_t>(book.spread)); });
+    }
+    if (total == 0) {
+        std::cerr << "band_quantity found no liquidity" << std::endl;
+    }
+}
+
+/*
+ * Cost of sweeping about half of a side's resting quantity, alternating sides
+ */
+template<typename Book>
+void sweepCost(BenchBook<Book>& book, BenchResult& result) {
+    Quantity quantity = static_cast<Quantity>(book.resting.size()) * 25 / 2;
+    std::int64_t notional = 0;
+    for (int i = 0; i < BENCH_OPERATIONS; i++) {
+        Side side = (i % 2 == 0) ? Side::Buy : Side::Sell;
+        result.time([&] { notional += book.orderbook.getSweepCost(side, quantity).notional; });
+    }
+    if (notional == 0) {
+        std::cerr << "sweep_cost found no liquidity" << std::endl;
+    }
+}
+
+/*
+ * Fill-or-kill orders that are all rejected: alternately priced away from the touch, and crossing
+ * the whole side but for more than rests on it
+ */
+template<typename Book>
+void fokReject(BenchBook<Book>& book, BenchResult& result) {
+    Quantity tooLarge = static_cast<Quantity>(book.resting.size()) * 100 + 1;
+    OrderId rejected = INVALID_ORDER_ID;
+    for (int i = 0; i < BENCH_OPERATIONS; i++) {
+        bool away = (i % 2 == 0);
+        Price price = away ? BENCH_MID_PRICE - book.spread : BENCH_MID_PRICE + book.spread;
+        Quantity quantity = away ? 1 : tooLarge;
+        book.trades.clear();
+        result.time([&] { rejected = book.orderbook.addOrder(price, quantity, Side::Buy, OrderType::FillOrKill, book.trades); });
+        if (rejected != INVALID_ORDER_ID) {
+            std::cerr << "fok_reject filled an order" << std::endl;
+        }
+    }
+}
+
+/*
+ * The depth kernels on their own over a packed array of levels ticks (AVX2 against the scalar loop):
+ * the sum of every tick, and a sweep of half the total quantity
+ */
+void depthKernels(int levels, std::vector<BenchResult>& results) {
+    RandomNumber rn(BENCH_SEED);
+    std::vector<Quantity> quantities(levels);
+    for (Quantity& quantity : quantities) {
+        quantity = rn.rndInt(1, 100);
+    }
+    std::uint64_t target = sumQuantitiesScalar(quantities.data(), quantities.size()) / 2;
+    std::uint64_t check = 0;
+
+    auto run = [&](const std::string& workload, const std::string& engine, auto kernel) {
+        results.push_back(BenchResult{workload, engine, levels, levels, {}, 0});
+        for (int i = 0; i < BENCH_OPERATIONS; i++) {
+            results.back().time([&] { check += kernel(); });
+        }
+    };
+    run("band_sum", "scalar", [&] { return sumQuantitiesScalar(quantities.data(), quantities.size()); });
+    run("sweep_kernel", "scalar", [&] { return sweepQuantitiesScalar(quantities.data(), quantities.size(), target).weighted; });
+#if defined(DEPTH_KERNELS_AVX2)
+    if (hasAvx2()) {
+        run("band_sum", "avx2", [&] { return sumQuantitiesAvx2(quantities.data(), quantities.size()); });
+        run("sweep_kernel", "avx2", [&] { return sweepQuantitiesAvx2(quantities.data(), quantities.size(), target).weighted; });
+    }
+#endif
+    if (check == 0) {
+        std::cerr << "depth kernels summed nothing" << std::endl;
+    }
+}
+
+/*
+ * Fill a book for the agent loops with result.depth orders a side around the fair price
+ */
+void prefillAgentBook(Orderbook& orderbook, RandomNumber& rn, const BenchResult& result) {
+    Trades trades;
+    const Price fairPrice = static_cast<Price>(FAIR_PRICE);
+    for (int i = 0; i < result.depth; i++) {
+        Price offset = 1 + rn.rndInt(0, result.spread - 1);
+        orderbook.addOrder(std::max<Price>(1, fairPrice - offset), rn.rndInt(1, 100), Side::Buy, OrderType::LimitOrder, trades);
+        orderbook.addOrder(fairPrice + offset, rn.rndInt(1, 100), Side::Sell, OrderType::LimitOrder, trades);
+    }
+}
+
+/*
+ * One tick of BENCH_AGENTS agents trading against a prefilled book (agents trade the heap engine)
+ */
+void agentLoop(BenchResult& result) {
+    Orderbook orderbook;
+    RandomNumber rn(BENCH_SEED);
+    prefillAgentBook(orderbook, rn, result);
+
+    std::vector<BacktestAgent> agents;
+    for (int i = 0; i < BENCH_AGENTS; i++) {
+        agents.push_back(BacktestAgent(rn.rndInt(1, 10000), orderbook));
+    }
+    AgentSimulation simulation(agents);
+    for (int i = 0; i < BENCH_AGENT_TICKS; i++) {
+        result.time([&] { simulation.step(i); });
+    }
+}
+
+/*
+ * The same agents and ticks as agentLoop, run by the structure-of-arrays AgentPopulation
+ */
+void agentPopulationLoop(BenchResult& result) {
+    Orderbook orderbook;
+    RandomNumber rn(BENCH_SEED);
+    prefillAgentBook(orderbook, rn, result);
+
+    AgentPopulation population(orderbook);
+    population.reserve(BENCH_AGENTS);
+    for (int i = 0; i < BENCH_AGENTS; i++) {
+        population.addAgent(rn.rndInt(1, 10000));
+    }
+    for (int i = 0; i < BENCH_AGENT_TICKS; i++) {
+        result.time([&] { population.step(i); });
+    }
+}
+
+template<typename Book, typename Workload>
+BenchResult runWorkload(const std::string& workload, const std::string& engine, int depth, int spread, Workload run) {
+    BenchResult result{workload, engine, depth, spread, {}, 0};
+    BenchBook<Book> book(depth, spread);
+    run(book, result);
+    return result;
+}
+
+template<typename Book>
+void runEngine(const std::string& engine, int depth, int spread, std::vector<BenchResult>& results) {
+    results.push_back(runWorkload<Book>("deep_insert", engine, depth, spread, deepInsert<Book>));
+    results.push_back(runWorkload<Book>("cancel_churn", engine, depth, spread, cancelChurn<Book>));
+    results.push_back(runWorkload<Book>("sweep", engine, depth, spread, sweep<Book>));
+    results.push_back(runWorkload<Book>("modify_storm", engine, depth, spread, modifyStorm<Book>));
+    results.push_back(runWorkload<Book>("amend_down", engine, depth, spread, amendDown<Book>));
+    results.push_back(runWorkload<Book>("depth_snapshot", engine, depth, spread, depthSnapshot<Book>));
+    results.push_back(runWorkload<Book>("band_quantity", engine, depth, spread, bandQuantity<Book>));
+    results.push_back(runWorkload<Book>("sweep_cost", engine, depth, spread, sweepCost<Book>));
+    results.push_back(runWorkload<Book>("fok_reject", engine, depth, spread, fokReject<Book>));
+}
+
+void printResults(const std::vector<BenchResult>& results, bool json) {
+    double rate = cyclesPerNanosecond();
+    auto nanoseconds = [rate](std::uint64_t cycles) {
+        return static_cast<double>(cycles) / rate;
+    };
+
+    if (json) {
+        std::cout << "[" << std::endl;
+    } else {
+        std::cout << "workload,engine,depth,spread,operations,mean_ns,p50_ns,p99_ns,p999_ns,max_ns" << std::endl;
+    }
+    for (std::size_t i = 0; i < results.size(); i++) {
+        const BenchResult& result = results[i];
+        const LatencyHistogram& histogram = result.histogram;
+        double mean = nanoseconds(result.totalCycles) / static_cast<double>(histogram.getCount());
+        if (json) {
+            std::cout << "  {\"workload\": \"" << result.workload << "\", \"engine\": \"" << result.engine
+                      << "\", \"depth\": " << result.depth << ", \"spread\": " << result.spread
+                      << ", \"operations\": " << histogram.getCount() << ", \"mean_ns\": " << mean
+                      << ", \"p50_ns\": " << nanoseconds(histogram.percentile(50))
+                      << ", \"p99_ns\": " << nanoseconds(histogram.percentile(99))
+                      << ", \"p999_ns\": " << nanoseconds(histogram.percentile(99.9))
+                      << ", \"max_ns\": " << nanoseconds(histogram.getMax()) << "}"
+                      << (i + 1 < results.size() ? "," : "") << std::endl;
+        } else {
+            std::cout << result.workload << "," << result.engine << "," << result.depth << "," << result.spread << ","
+                      << histogram.getCount() << "," << mean << "," << nanoseconds(histogram.percentile(50)) << ","
+                      << nanoseconds(histogram.percentile(99)) << "," << nanoseconds(histogram.percentile(99.9)) << ","
+                      << nanoseconds(histogram.getMax()) << std::endl;
+        }
+    }
+    if (json) {
+        std::cout << "]" << std::endl;
+    }
+}
+
+/*
+ * Benchmark suite of canonical orderbook workloads over a grid of book depths and price spreads
+ *
+ * Usage: bench [csv|json]
+ * Every workload runs on the heap, ladder and tree engines and on two other policy specialisations
+ * (heap with per-order heap allocations, ladder with wall clock timestamps, a trade counter and
+ * latency histograms), the agent loop on the heap engine the agents trade. Times are per
+ * operation, only the operation itself is timed (set up and refills are not). The depth kernels
+ * are also timed on their own, AVX2 against the scalar loop (depth and spread are the tick count).
+ */
+int main(int argc, char* argv[]) {
+    std::string format = argc > 1 ? argv[1] : "csv";
+    if (format != "csv" && format != "json") {
+        std::cerr << "usage: bench [csv|json]" << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    for (int depth : BOOK_DEPTHS) {
+        for (int spread : PRICE_SPREADS) {
+            runEngine<Orderbook>("heap", depth, spread, results);
+            runEngine<LadderOrderbook>("ladder", depth, spread, results);
+            runEngine<TreeOrderbook>("tree", depth, spread, results);
+            runEngine<MemoryPoolOrderbook>("heap_memory_pool", depth, spread, results);
+            runEngine<InstrumentedLadderOrderbook>("ladder_instrumented", depth, spread, results);
+
+            results.push_back(BenchResult{"agent_loop", "heap", depth, spread, {}, 0});
+            agentLoop(results.back());
+            results.push_back(BenchResult{"agent_population", "heap", depth, spread, {}, 0});
+            agentPopulationLoop(results.back());
+        }
+    }
+
+    for (int levels : KERNEL_LEVELS) {
+        depthKernels(levels, results);
+    }
+
+    printResults(results, format == "json");
+    return 0;
+}
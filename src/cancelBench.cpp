@@ -0,0 +1,47 @@
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include "Orderbook.h"
+#include "RandomNumber.h"
+
+const int CANCELS_PER_DEPTH = 100000;
+const std::vector<int> LEVEL_DEPTHS = {10, 100, 1000, 10000, 100000};
+
+/*
+ * Average cancel latency (ns) for an orderbook with a single bid level of the given depth.
+ * Each cancel removes a random order from the level and a new order is added to keep the depth.
+ */
+template<typename Book>
+double cancelLatency(int depth) {
+    Book orderbook;
+    RandomNumber rn(1234);
+
+    std::vector<OrderId> resting;
+    resting.reserve(depth);
+    for (int i = 0; i < depth; i++) {
+        resting.push_back(orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first);
+    }
+
+    std::chrono::nanoseconds total(0);
+    for (int i = 0; i < CANCELS_PER_DEPTH; i++) {
+        int index = rn.rndInt(0, depth - 1);
+
+        auto start = std::chrono::steady_clock::now();
+        orderbook.cancelOrder(resting[index]);
+        total += std::chrono::steady_clock::now() - start;
+
+        resting[index] = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+    }
+    return static_cast<double>(total.count()) / CANCELS_PER_DEPTH;
+}
+
+/*
+ * Benchmark cancel latency as the depth of a price level grows
+ */
+int main() {
+    std::cout << "Level depth, Heap engine cancel (ns), Ladder engine cancel (ns)" << std::endl;
+    for (int depth : LEVEL_DEPTHS) {
+        std::cout << depth << ", " << cancelLatency<Orderbook>(depth) << ", " << cancelLatency<LadderOrderbook>(depth) << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,27 @@
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "OrderEventFile.h"
+
+/*
+ * Convert a text order file (one "side price quantity" line per order, as written by
+ * python/order_generator.py) into the binary order event format
+ *
+ * Usage: order_converter [input.txt] [output.bin]
+ */
+int main(int argc, char* argv[]) {
+    std::string inputPath = argc > 1 ? argv[1] : "output/orders.txt";
+    std::string outputPath = argc > 2 ? argv[2] : "output/orders.bin";
+
+    std::vector<OrderEvent> events;
+    try {
+        events = OrderEventFile::readText(inputPath);
+    } catch (const std::runtime_error& error) {
+        std::cerr << "error: " << error.what() << std::endl;
+        return 1;
+    }
+
+    OrderEventFile::write(outputPath, events);
+    std::cout << "Wrote " << events.size() << " events to " << outputPath << std::endl;
+    return 0;
+}
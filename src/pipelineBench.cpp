@@ -0,0 +1,121 @@
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <chrono>
+#include "Orderbook.h"
+#include "OrderPipeline.h"
+#include "OrderEventFile.h"
+
+struct BenchResult {
+    double seconds;
+    std::vector<std::int64_t> latencies; // ns from decode to confirmation, per command
+};
+
+std::int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/*
+ * Inline mode: decode and match on the same thread
+ */
+BenchResult runInline(const std::vector<std::string>& lines) {
+    LadderOrderbook orderbook;
+    BenchResult result{0, {}};
+    result.latencies.reserve(lines.size());
+    Trades trades;
+    OrderEvent event;
+
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& line : lines) {
+        if (!OrderEventFile::parseTextLine(line, event)) {
+            continue;
+        }
+        std::int64_t decoded = nowNanos();
+        trades.clear();
+        applyOrderEvent(orderbook, event, trades);
+        result.latencies.push_back(nowNanos() - decoded);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+/*
+ * Pipelined mode: the gateway (this thread) decodes into the command ring and polls reports,
+ * the pipeline's matching thread matches
+ */
+BenchResult runPipelined(const std::vector<std::string>& lines) {
+    LadderOrderbook orderbook;
+    BenchResult result{0, {}};
+    result.latencies.reserve(lines.size());
+    std::vector<ExecutionReport> reports(PIPELINE_BATCH_SIZE);
+    std::uint64_t submitted = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        OrderPipeline<LadderOrderbook> pipeline(orderbook);
+
+        auto pollReports = [&] {
+            std::size_t count = pipeline.poll(reports.data(), reports.size());
+            std::int64_t received = nowNanos();
+            for (std::size_t i = 0; i < count; ++i) {
+                if (reports[i].reportType == ReportType::Confirmation) {
+                    result.latencies.push_back(received - reports[i].submitNanos);
+                }
+            }
+        };
+
+        OrderCommand command;
+        for (const auto& line : lines) {
+            if (!OrderEventFile::parseTextLine(line, command.event)) {
+                continue;
+            }
+            command.sequence = submitted++;
+            command.submitNanos = nowNanos();
+            while (!pipeline.trySubmit(command)) {
+                pollReports();
+            }
+            pollReports();
+        }
+        while (result.latencies.size() < submitted) {
+            pollReports();
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void printResult(const std::string& mode, BenchResult& result) {
+    std::sort(result.latencies.begin(), result.latencies.end());
+    auto percentile = [&](double p) {
+        return result.latencies[static_cast<std::size_t>(p * (result.latencies.size() - 1))];
+    };
+    std::cout << mode << ", " << result.seconds << ", " << static_cast<std::size_t>(result.latencies.size() / result.seconds) << ", "
+              << percentile(0.5) << ", " << percentile(0.99) << ", " << percentile(0.999) << ", " << result.latencies.back() << std::endl;
+}
+
+/*
+ * Compare end-to-end latency and throughput of the pipelined (gateway + matching thread) mode
+ * against the inline mode, decoding the text orders written by python/order_generator.py
+ *
+ * Usage: pipeline_bench [orders file]
+ */
+int main(int argc, char* argv[]) {
+    std::ifstream infile(argc > 1 ? argv[1] : "output/orders.txt");
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(infile, line)) {
+        lines.push_back(line);
+    }
+    if (lines.empty()) {
+        std::cerr << "error: no orders to replay" << std::endl;
+        return 1;
+    }
+
+    BenchResult inlineResult = runInline(lines);
+    BenchResult pipelinedResult = runPipelined(lines);
+
+    std::cout << "Mode, Seconds, Orders/s, p50 (ns), p99 (ns), p99.9 (ns), Max (ns)" << std::endl;
+    printResult("Inline", inlineResult);
+    printResult("Pipelined", pipelinedResult);
+    return 0;
+}
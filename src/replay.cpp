@@ -0,0 +1,61 @@
+#include <iostream>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include "Orderbook.h"
+#include "OrderEventFile.h"
+#include "ReplayEngine.h"
+
+void printReport(const std::string& engine, const ReplayReport& report) {
+    std::cout << engine << report.seconds << "s, " << static_cast<std::size_t>(report.eventsPerSecond()) << " events/s, "
+              << report.trades << " trades, " << report.checkpoints.size() << " checkpoints, checksum " << std::hex
+              << report.checksum << std::dec << std::endl;
+}
+
+/*
+ * Replay an event log through every engine and check they behave bit-identically
+ *
+ * Usage: replay [events file] [checkpoint interval]
+ * - an order event file (see order_converter) is memory mapped and replayed in place
+ * - a journal (see stress_test_journal) is replayed from its adds, cancels and modifies
+ */
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "output/orders.bin";
+    std::size_t interval = argc > 2 ? std::stoul(argv[2]) : REPLAY_CHECKPOINT_INTERVAL;
+
+    // the magic at the start of the file tells the two formats apart
+    char magic[4] = {};
+    std::ifstream(path, std::ios::binary).read(magic, sizeof(magic));
+
+    std::unique_ptr<OrderEventFile> eventFile;
+    std::vector<OrderEvent> journalEvents;
+    const OrderEvent* begin;
+    const OrderEvent* end;
+    if (std::memcmp(magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) == 0) {
+        journalEvents = journalToEvents(Journal::read(path));
+        begin = journalEvents.data();
+        end = journalEvents.data() + journalEvents.size();
+    } else {
+        eventFile = std::make_unique<OrderEventFile>(path);
+        begin = eventFile->begin();
+        end = eventFile->end();
+    }
+    std::cout << "Events: " << (end - begin) << ", checkpoint every " << interval << std::endl;
+
+    Orderbook heapOrderbook;
+    ReplayReport heapReport = replayEvents(heapOrderbook, begin, end, interval);
+    printReport("Heap engine:   ", heapReport);
+
+    LadderOrderbook ladderOrderbook;
+    ReplayReport ladderReport = replayEvents(ladderOrderbook, begin, end, interval);
+    printReport("Ladder engine: ", ladderReport);
+
+    std::optional<std::size_t> divergence = firstDivergence(heapReport, ladderReport);
+    if (divergence) {
+        std::cerr << "error: engines diverged by event " << *divergence << std::endl;
+        return 1;
+    }
+    std::cout << "Engines are bit-identical at every checkpoint" << std::endl;
+    return 0;
+}
@@ -0,0 +1,78 @@
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "ShardedEngine.h"
+#include "RandomNumber.h"
+
+const InstrumentId NUMBER_OF_INSTRUMENTS = 64;
+const std::size_t NUMBER_OF_EVENTS = 2000000;
+const int CANCEL_CHANCE = 20; // percent of events that cancel an earlier order
+const Price FAIR_PRICE = 1000;
+const Price PRICE_RANGE = 20;
+
+/*
+ * Multi-instrument workload: limit orders around a fair price, with some cancels of earlier orders
+ */
+std::vector<InstrumentEvent> generateWorkload() {
+    RandomNumber rn(1234);
+    std::vector<OrderId> nextOrderIds(NUMBER_OF_INSTRUMENTS, 0);
+    std::vector<InstrumentEvent> events;
+    events.reserve(NUMBER_OF_EVENTS);
+
+    for (std::size_t i = 0; i < NUMBER_OF_EVENTS; ++i) {
+        InstrumentId instrument = rn.rndInt(0, NUMBER_OF_INSTRUMENTS - 1);
+        OrderEvent event{};
+        if (nextOrderIds[instrument] > 0 && rn.rndInt(0, 99) < CANCEL_CHANCE) {
+            event.eventType = OrderEventType::Cancel;
+            event.orderId = rn.rndInt(0, nextOrderIds[instrument] - 1);
+        } else {
+            event.eventType = OrderEventType::Add;
+            event.side = static_cast<Side>(rn.rndInt(0, 1));
+            event.orderType = OrderType::LimitOrder;
+            event.price = FAIR_PRICE + rn.rndInt(-PRICE_RANGE, PRICE_RANGE);
+            event.quantity = rn.rndInt(1, 100);
+            ++nextOrderIds[instrument];
+        }
+        events.push_back(InstrumentEvent{instrument, event});
+    }
+    return events;
+}
+
+/*
+ * Benchmark the sharded engine from 1 to N matching threads
+ *
+ * Usage: shard_bench [max threads]
+ */
+int main(int argc, char* argv[]) {
+    unsigned maxThreads = argc > 1 ? std::stoul(argv[1]) : std::max(1u, std::thread::hardware_concurrency());
+    std::vector<InstrumentEvent> events = generateWorkload();
+
+    auto bookFactory = [](InstrumentId) {
+        return std::make_unique<LadderOrderbook>(LadderLevels(FAIR_PRICE - PRICE_RANGE, FAIR_PRICE + PRICE_RANGE));
+    };
+
+    std::cout << "Threads, Seconds, Events/s, Speedup, Trades" << std::endl;
+    double baseline = 0;
+    for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+        ShardedEngine<LadderOrderbook> engine(threads, 1 << 16, bookFactory);
+
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& event : events) {
+            engine.submit(event.instrument, event.event);
+        }
+        engine.flush();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::size_t trades = 0;
+        for (std::size_t shard = 0; shard < engine.getNumShards(); ++shard) {
+            trades += engine.getShardStats(shard).trades;
+        }
+        if (threads == 1) {
+            baseline = seconds;
+        }
+        std::cout << threads << ", " << seconds << ", " << static_cast<std::size_t>(events.size() / seconds) << ", "
+                  << baseline / seconds << ", " << trades << std::endl;
+    }
+    return 0;
+}
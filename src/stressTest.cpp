@@ -1,38 +1,105 @@
 #include <iostream>
-#include <fstream> 
-#include <sstream> 
+#include <chrono>
+#include <optional>
 #include "Orderbook.h"
 #include "Order.h"
 #include "OrderbookLevelInfos.h"
+#include "OrderEventFile.h"
+#include "Journal.h"
+#include "ReplayEngine.h"
+
+void printResult(const std::string& engine, const ReplayReport& result, std::size_t numEvents) {
+    std::cout << engine << result.seconds << "s, " << result.trades << " trades, "
+              << static_cast<std::size_t>(numEvents / result.seconds) << " orders/s" << std::endl;
+}
 
 /*
  * Stress test the Orderbook class for benchmarking 
+ *
+ * Usage: stress_test [orders file] [journal file]
+ * - a .bin file is memory mapped and replayed in place (see order_converter)
+ * - anything else is parsed as the text format written by python/order_generator.py
+ * - with a journal file, the heap engine is replayed again with journaling on to measure its overhead
  */
-int main() {
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "output/orders.txt";
+    bool binary = path.size() >= 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+
+    auto loadStart = std::chrono::steady_clock::now();
+    std::vector<OrderEvent> textEvents;
+    std::unique_ptr<OrderEventFile> binaryEvents;
+    const OrderEvent* begin;
+    const OrderEvent* end;
+    if (binary) {
+        binaryEvents = std::make_unique<OrderEventFile>(path);
+        begin = binaryEvents->begin();
+        end = binaryEvents->end();
+    } else {
+        textEvents = OrderEventFile::readText(path);
+        begin = textEvents.data();
+        end = textEvents.data() + textEvents.size();
+    }
+    double loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+    std::size_t numEvents = static_cast<std::size_t>(end - begin);
 
     Orderbook orderbook;
+    ReplayReport heapResult = replayEvents(orderbook, begin, end, 0);
+
+    LadderOrderbook ladderOrderbook;
+    ReplayReport ladderResult = replayEvents(ladderOrderbook, begin, end, 0);
+
+    // warm start: checkpoint the final book and restore it into a new one
+    auto saveStart = std::chrono::steady_clock::now();
+    orderbook.saveSnapshot("output/snapshot.bin");
+    auto loadSnapshotStart = std::chrono::steady_clock::now();
+    Orderbook restoredOrderbook;
+    restoredOrderbook.loadSnapshot("output/snapshot.bin");
+    auto loadSnapshotEnd = std::chrono::steady_clock::now();
+    std::cout << "Snapshot: " << restoredOrderbook.getNumOrders() << " orders saved in "
+              << std::chrono::duration<double, std::milli>(loadSnapshotStart - saveStart).count() << "ms, restored in "
+              << std::chrono::duration<double, std::milli>(loadSnapshotEnd - loadSnapshotStart).count() << "ms" << std::endl;
+
+    // journaling overhead: the same replay with every event and trade appended to the journal
+    std::optional<ReplayReport> journalResult;
+    if (argc > 2) {
+        Journal journal(argv[2]);
+        Orderbook journalOrderbook;
+        journalOrderbook.setJournal(&journal);
+        journalResult = replayEvents(journalOrderbook, begin, end, 0);
 
-    std::ifstream infile("output/orders.txt");
-    std::string line;
-
-    while (std::getline(infile, line)) {
-        std::istringstream iss(line);
-        int flag;
-        double price;
-        int quantity;
-        
-        if (!(iss >> flag >> price >> quantity)) {
-            std::cerr << "error: " << line << std::endl;
-            continue;
-        }
-
-        Side side = (flag == 1) ? Side::Buy : Side::Sell;
-        
-        orderbook.addOrder(price, quantity, side, OrderType::LimitOrder);
+        auto syncStart = std::chrono::steady_clock::now();
+        journal.sync();
+        double syncSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - syncStart).count();
+        JournalStats journalStats = journal.getStats();
+        std::cout << "Journal: " << journalStats.records << " records, " << journalStats.bytesWritten / (1024 * 1024) << "MB in "
+                  << journalStats.writes << " writes, " << journalStats.buffers << " buffers, " << syncSeconds << "s to sync after the replay"
+                  << (journalStats.failed ? " (write failed)" : "") << std::endl;
     }
 
-    infile.close();
     orderbook.printOrderbook();
+
+    std::cout << "Orders: " << numEvents << " (" << (binary ? "mapped" : "parsed") << " in " << loadSeconds << "s)" << std::endl;
+    printResult("Heap engine:   ", heapResult, numEvents);
+    printResult("Ladder engine: ", ladderResult, numEvents);
+    if (journalResult) {
+        printResult("Heap engine with journal: ", *journalResult, numEvents);
+        std::cout << "Journal overhead: " << (journalResult->seconds / heapResult.seconds - 1.0) * 100.0 << "%" << std::endl;
+    }
+
+    const PoolStats& poolStats = orderbook.getPoolStats();
+    std::cout << "Order pool: " << poolStats.highWaterMark << " high water mark, " << poolStats.misses << " misses, "
+              << poolStats.chunks << " chunks (" << poolStats.capacity << " orders)" << std::endl;
+
+#ifdef ORDERBOOK_LATENCY
+    printLatencyReport(orderbook.getInstrumentation().getLatency(), "Heap engine");
+    printLatencyReport(ladderOrderbook.getInstrumentation().getLatency(), "Ladder engine");
+#endif
+
+    if (heapResult.checksum != ladderResult.checksum || (journalResult && journalResult->checksum != heapResult.checksum)) {
+        std::cerr << "error: engines produced different trades" << std::endl;
+        return 1;
+    }
+    std::cout << "Engines produced identical trades" << std::endl;
     return 0;
 
-}
\ No newline at end of file
+}
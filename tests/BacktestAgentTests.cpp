@@ -3,6 +3,8 @@
 #include <string>
 #include "Orderbook.h"
 #include "BacktestAgent.h"
+#include "AgentSimulation.h"
+#include "AgentPopulation.h"
 #include "RandomNumber.h"
 #include <cassert>
 
@@ -62,8 +64,99 @@ void testBacktestAgentSeedingConsistent() {
     std::cout << "testBacktestAgentSeedingConsistent passed.\n";
 }
 
+void testParallelActionsMatchSerial() {
+    RandomNumber rn1 = RandomNumber();
+    rn1.setSeed(SEED);
+
+    Orderbook serialOrderbook = Orderbook();
+    Orderbook parallelOrderbook = Orderbook();
+
+    std::vector<BacktestAgent> serialAgents;
+    std::vector<BacktestAgent> parallelAgents;
+
+    for (int i = 0; i < NUMBER_OF_AGENTS; i++) {
+        Lehmer32_t seed = rn1.rndInt(1, 10000);
+        serialAgents.push_back(BacktestAgent(seed, serialOrderbook));
+        parallelAgents.push_back(BacktestAgent(seed, parallelOrderbook));
+    }
+
+    AgentSimulation serial(serialAgents);
+    AgentSimulation parallel(parallelAgents, 4);
+
+    for (int i = 0; i < TEST_DAYS * TICKS_IN_DAY; i++) {
+        serial.step(i);
+        parallel.step(i);
+    }
+
+    // the books should be identical level by level
+    LevelInfos serialBids = serialOrderbook.getOrderInfos().getBids();
+    LevelInfos parallelBids = parallelOrderbook.getOrderInfos().getBids();
+    LevelInfos serialAsks = serialOrderbook.getOrderInfos().getAsks();
+    LevelInfos parallelAsks = parallelOrderbook.getOrderInfos().getAsks();
+
+    assert(serialOrderbook.getNumOrders() == parallelOrderbook.getNumOrders());
+    assert(serialBids.size() == parallelBids.size() && serialAsks.size() == parallelAsks.size());
+    for (size_t j = 0; j < serialBids.size(); ++j) {
+        assert(serialBids[j].price == parallelBids[j].price && serialBids[j].quantity == parallelBids[j].quantity);
+    }
+    for (size_t j = 0; j < serialAsks.size(); ++j) {
+        assert(serialAsks[j].price == parallelAsks[j].price && serialAsks[j].quantity == parallelAsks[j].quantity);
+    }
+
+    std::cout << "testParallelActionsMatchSerial passed.\n";
+}
+
+void testAgentPopulationMatchesAgents() {
+    RandomNumber rn1 = RandomNumber();
+    rn1.setSeed(SEED);
+
+    Orderbook agentOrderbook = Orderbook();
+    Orderbook populationOrderbook = Orderbook();
+
+    std::vector<BacktestAgent> agents;
+    AgentPopulation population(populationOrderbook);
+    population.reserve(NUMBER_OF_AGENTS);
+
+    for (int i = 0; i < NUMBER_OF_AGENTS; i++) {
+        Lehmer32_t seed = rn1.rndInt(1, 10000);
+        agents.push_back(BacktestAgent(seed, agentOrderbook));
+        population.addAgent(seed);
+    }
+
+    AgentSimulation simulation(agents);
+    for (int i = 0; i < TEST_DAYS * TICKS_IN_DAY; i++) {
+        simulation.step(i);
+        population.step(i);
+    }
+
+    // every agent ends in the same state, and the books are identical level by level
+    assert(population.size() == agents.size());
+    for (size_t j = 0; j < agents.size(); ++j) {
+        assert(population.getCash(j) == agents[j].getCash() && population.getHoldings(j) == agents[j].getHoldings());
+        assert(population.getNumPendingOrders(j) == agents[j].getNumPendingOrders());
+    }
+
+    LevelInfos agentBids = agentOrderbook.getOrderInfos().getBids();
+    LevelInfos populationBids = populationOrderbook.getOrderInfos().getBids();
+    LevelInfos agentAsks = agentOrderbook.getOrderInfos().getAsks();
+    LevelInfos populationAsks = populationOrderbook.getOrderInfos().getAsks();
+
+    assert(agentOrderbook.getNumOrders() == populationOrderbook.getNumOrders());
+    assert(agentBids.size() == populationBids.size() && agentAsks.size() == populationAsks.size());
+    for (size_t j = 0; j < agentBids.size(); ++j) {
+        assert(agentBids[j].price == populationBids[j].price && agentBids[j].quantity == populationBids[j].quantity);
+    }
+    for (size_t j = 0; j < agentAsks.size(); ++j) {
+        assert(agentAsks[j].price == populationAsks[j].price && agentAsks[j].quantity == populationAsks[j].quantity);
+    }
+
+    std::cout << "testAgentPopulationMatchesAgents passed.\n";
+}
+
 int main() {
     testBacktestAgentSeedingConsistent();
+    testParallelActionsMatchSerial();
+    testAgentPopulationMatchesAgents();
     std::cout << "All tests passed.\n";
     return 0;
 }
@@ -0,0 +1,106 @@
+#include "OrderTable.h"
+#include "Order.h"
+#include <cassert>
+#include <iostream>
+#include <vector>
+
+const OrderId PAGE_IDS = OrderId(1) << ORDER_TABLE_PAGE_BITS;
+
+// orders for ids [begin, end), inserted into the table in id order
+void insertOrders(OrderTable& table, std::vector<Order>& orders, OrderId begin, OrderId end) {
+    for (OrderId id = begin; id < end; ++id) {
+        orders[id] = Order(id, 100, 1, Side::Buy, OrderType::LimitOrder);
+        table.insert(&orders[id]);
+    }
+}
+
+void testFindInsertTake() {
+    std::vector<Order> orders(PAGE_IDS * 2);
+    OrderTable table;
+    insertOrders(table, orders, 0, PAGE_IDS * 2);
+    assert(table.size() == static_cast<std::size_t>(PAGE_IDS * 2) && table.getNumPages() == 2);
+    assert(table.find(5) == &orders[5] && table.find(PAGE_IDS + 5) == &orders[PAGE_IDS + 5]);
+    assert(table.find(PAGE_IDS * 3) == nullptr && table.find(INVALID_ORDER_ID) == nullptr);
+
+    // a dead id finds nothing, and can't be taken twice
+    assert(table.take(5) == &orders[5]);
+    assert(table.find(5) == nullptr && table.take(5) == nullptr);
+    table.erase(5); // no-op
+    assert(table.size() == static_cast<std::size_t>(PAGE_IDS * 2 - 1));
+    std::cout << "testFindInsertTake passed.\n";
+}
+
+void testSlot() {
+    std::vector<Order> orders(PAGE_IDS * 2);
+    OrderTable table;
+    insertOrders(table, orders, 0, PAGE_IDS * 2);
+
+    // a found slot reads the order and erases it without another lookup
+    OrderTable::Slot slot = table.findSlot(7);
+    assert(slot.get() == &orders[7]);
+    table.erase(slot);
+    assert(table.find(7) == nullptr && table.findSlot(7).get() == nullptr);
+    assert(table.size() == static_cast<std::size_t>(PAGE_IDS * 2 - 1));
+
+    // ids never handed out resolve to an empty slot
+    assert(table.findSlot(PAGE_IDS * 5).get() == nullptr && table.findSlot(INVALID_ORDER_ID).get() == nullptr);
+
+    // erasing the last order of a page through its slot frees the page like take does
+    for (OrderId id = 0; id < PAGE_IDS - 1; ++id) {
+        table.erase(id);
+    }
+    assert(table.getNumPages() == 2);
+    table.erase(table.findSlot(PAGE_IDS - 1));
+    assert(table.find(PAGE_IDS - 1) == nullptr && table.size() == static_cast<std::size_t>(PAGE_IDS));
+    std::cout << "testSlot passed.\n";
+}
+
+void testPageReclaimedOnlyWhenEveryIdIsDead() {
+    std::vector<Order> orders(PAGE_IDS * 3 + 1);
+    OrderTable table;
+    insertOrders(table, orders, 0, PAGE_IDS * 3);
+    assert(table.getNumPages() == 3);
+
+    // emptying page 0 frees it into the spare, so the page count only drops once page 1 is freed too
+    for (OrderId id = 0; id < PAGE_IDS; ++id) {
+        table.erase(id);
+    }
+    assert(table.getNumPages() == 3 && table.find(0) == nullptr);
+
+    // cancelled out of sequence: page 1 is kept while any later id on it is alive
+    table.erase(PAGE_IDS + PAGE_IDS / 2);
+    table.erase(PAGE_IDS);
+    for (OrderId id = PAGE_IDS + 2; id < PAGE_IDS * 2 - 1; ++id) {
+        if (id != PAGE_IDS + PAGE_IDS / 2) {
+            table.erase(id);
+        }
+    }
+    assert(table.getNumPages() == 3);
+    assert(table.find(PAGE_IDS + 1) == &orders[PAGE_IDS + 1]);
+    assert(table.find(PAGE_IDS * 2 - 1) == &orders[PAGE_IDS * 2 - 1]);
+
+    table.erase(PAGE_IDS * 2 - 1);
+    assert(table.getNumPages() == 3 && table.find(PAGE_IDS + 1) == &orders[PAGE_IDS + 1]);
+
+    // the last live id on the page goes, so the page is freed
+    table.erase(PAGE_IDS + 1);
+    assert(table.getNumPages() == 2 && table.find(PAGE_IDS + 1) == nullptr);
+    assert(table.size() == static_cast<std::size_t>(PAGE_IDS));
+
+    // the next new page reuses the spare rather than allocating
+    insertOrders(table, orders, PAGE_IDS * 3, PAGE_IDS * 3 + 1);
+    assert(table.getNumPages() == 2 && table.find(PAGE_IDS * 3) == &orders[PAGE_IDS * 3]);
+
+    // the page ids are still being handed out from is kept even when empty
+    table.erase(PAGE_IDS * 3);
+    assert(table.find(PAGE_IDS * 3) == nullptr && table.getNumPages() == 2);
+    std::cout << "testPageReclaimedOnlyWhenEveryIdIsDead passed.\n";
+}
+
+int main() {
+    testFindInsertTake();
+    testSlot();
+    testPageReclaimedOnlyWhenEveryIdIsDead();
+    std::cout << "All tests passed.\n";
+    return 0;
+}
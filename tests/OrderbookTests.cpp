@@ -1,4 +1,6 @@
 #include "Orderbook.h"
+#include "RandomNumber.h"
+#include "ReplayEngine.h"
 #include <cassert>
 #include <fstream>
 #include <sstream>
@@ -44,6 +46,23 @@ void testModifyOrder() {
     std::cout << "testModifyOrder passed.\n";
 }
 
+void testCancelOrderMiddleOfLevel() {
+    Orderbook orderbook;
+    OrderId first = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+    OrderId middle = orderbook.addOrder(100, 20, Side::Buy, OrderType::LimitOrder).first;
+    OrderId last = orderbook.addOrder(100, 30, Side::Buy, OrderType::LimitOrder).first;
+    orderbook.cancelOrder(middle);
+    assert(orderbook.getOrderInfos().getBids().front().quantity == 40);
+
+    // remaining orders keep their time priority
+    Trades trades = orderbook.addOrder(100, 40, Side::Sell, OrderType::LimitOrder).second;
+    assert(trades.size() == 2);
+    assert(trades[0].getBidTrade().orderId == first);
+    assert(trades[1].getBidTrade().orderId == last);
+    assert(orderbook.getNumOrders() == 0);
+    std::cout << "testCancelOrderMiddleOfLevel passed.\n";
+}
+
 void testGetOrderInfos() {
     Orderbook orderbook;
     orderbook.addOrder(100.0, 10, Side::Buy, OrderType::LimitOrder);
@@ -58,6 +77,29 @@ void testGetOrderInfos() {
     std::cout << "testGetOrderInfos passed.\n";
 }
 
+template<typename Book>
+void testGetDepth() {
+    Book orderbook;
+    orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder);
+    OrderId cancelled = orderbook.addOrder(100, 20, Side::Buy, OrderType::LimitOrder).first;
+    orderbook.addOrder(99, 5, Side::Buy, OrderType::LimitOrder);
+    orderbook.addOrder(98, 7, Side::Buy, OrderType::LimitOrder);
+    orderbook.addOrder(97, 1, Side::Buy, OrderType::LimitOrder);
+    OrderId emptied = orderbook.addOrder(101, 3, Side::Buy, OrderType::LimitOrder).first;
+    orderbook.cancelOrder(cancelled);
+    orderbook.cancelOrder(emptied);
+    orderbook.addOrder(99, 8, Side::Sell, OrderType::LimitOrder); // fills 100 x 8
+
+    // top 3 levels, aggregates reflect the cancel and the partial fill (empty levels skipped)
+    LevelInfo depth[3];
+    assert(orderbook.getDepth(Side::Buy, depth, 3) == 3);
+    assert(depth[0].price == 100 && depth[0].quantity == 2 && depth[0].orderCount == 1);
+    assert(depth[1].price == 99 && depth[1].quantity == 5 && depth[1].orderCount == 1);
+    assert(depth[2].price == 98 && depth[2].quantity == 7);
+    assert(orderbook.getDepth(Side::Sell, depth, 3) == 0);
+    std::cout << "testGetDepth passed.\n";
+}
+
 void testMatchOrdersPartialFill() {
     Orderbook orderbook;
     orderbook.addOrder(100.0, 10, Side::Buy, OrderType::LimitOrder);
@@ -79,6 +121,698 @@ void testMatchOrdersFullFill() {
     std::cout << "testMatchOrders passed.\n";
 }
 
+void testAddOrderTradeBuffer() {
+    Orderbook orderbook;
+    Trades trades;
+
+    // market order with nothing to match is rejected
+    assert(orderbook.addOrder(100, 10, Side::Buy, OrderType::MarketOrder, trades) == INVALID_ORDER_ID);
+
+    OrderId bid = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder, trades);
+    assert(bid != INVALID_ORDER_ID);
+    assert(trades.empty());
+
+    // trades are appended to the caller's buffer
+    OrderId ask = orderbook.addOrder(100, 4, Side::Sell, OrderType::LimitOrder, trades);
+    orderbook.addOrder(100, 6, Side::Sell, OrderType::LimitOrder, trades);
+    assert(trades.size() == 2);
+    assert(trades[0].getBidTrade().orderId == bid);
+    assert(trades[0].getAskTrade().orderId == ask);
+    assert(trades[1].getBidTrade().quantity == 6);
+    std::cout << "testAddOrderTradeBuffer passed.\n";
+}
+
+void testLadderCancelOrder() {
+    LadderOrderbook orderbook;
+    OrderConfirmation confirmation = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder);
+    orderbook.addOrder(99, 10, Side::Buy, OrderType::LimitOrder);
+    orderbook.cancelOrder(confirmation.first);
+    // ladder removes the emptied level straight away (no lazy deletion)
+    OrderBookLevelInfos infos = orderbook.getOrderInfos();
+    assert(infos.getBids().size() == 1);
+    assert(infos.getBids().front().price == 99);
+    assert(orderbook.getNumBids() == 1);
+    assert(orderbook.getNumOrders() == 1);
+    std::cout << "testLadderCancelOrder passed.\n";
+}
+
+void testLadderPriceBand() {
+    LadderOrderbook orderbook(LadderLevels(90, 110));
+    std::vector<JournalRecord> records;
+    {
+        Journal journal("output/band_test.bin");
+        orderbook.setJournal(&journal);
+        orderbook.addOrder(110, 10, Side::Sell, OrderType::LimitOrder);
+        bool thrown = false;
+        try {
+            orderbook.addOrder(111, 10, Side::Sell, OrderType::LimitOrder);
+        } catch (const std::out_of_range&) {
+            thrown = true;
+        }
+        assert(thrown);
+        orderbook.setJournal(nullptr);
+    }
+    records = Journal::read("output/band_test.bin");
+
+    // refused before anything happened: no pool slot, order, journal record or order id used
+    assert(orderbook.getPoolStats().inUse == 1 && orderbook.getNumOrders() == 1);
+    assert(records.size() == 1);
+
+    // and the same for a modify out of the band, a batch with one bad request and a stop-limit
+    bool thrown = false;
+    try {
+        orderbook.modifyOrder(0, 70000, 10, Side::Sell);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown && orderbook.getBestAsk() == 110);
+    OrderRequest requests[] = {{100, 5, Side::Buy, OrderType::LimitOrder}, {89, 5, Side::Buy, OrderType::LimitOrder}};
+    OrderId orderIds[2];
+    Trades trades;
+    thrown = false;
+    try {
+        orderbook.addOrderBatch(requests, 2, orderIds, trades);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown && orderbook.getNumOrders() == 1 && orderbook.getPoolStats().inUse == 1);
+
+    // an immediate-or-cancel rests at its price until the uncross, so in a batch it must fit the band too
+    OrderRequest immediateRequests[] = {{100, 5, Side::Buy, OrderType::LimitOrder}, {500, 5, Side::Buy, OrderType::ImmediateOrCancel}};
+    thrown = false;
+    try {
+        orderbook.addOrderBatch(immediateRequests, 2, orderIds, trades);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown && orderbook.getNumOrders() == 1 && orderbook.getPoolStats().inUse == 1);
+    thrown = false;
+    try {
+        orderbook.addStopLimitOrder(100, 70000, 5, Side::Buy, trades);
+    } catch (const std::out_of_range&) {
+        thrown = true;
+    }
+    assert(thrown && orderbook.getNumStops() == 0);
+
+    // immediate orders never rest, so any limit is fine
+    assert(orderbook.addOrder(70000, 5, Side::Buy, OrderType::ImmediateOrCancel, trades) == 1);
+    assert(orderbook.addOrder(100, 5, Side::Buy, OrderType::LimitOrder).first == 2);
+    std::cout << "testLadderPriceBand passed.\n";
+}
+
+// drive the heap engine and another book with the same random orders, they must trade identically
+template<typename Book>
+void checkMatchesHeapEngine(Book& otherOrderbook) {
+    Orderbook heapOrderbook;
+    RandomNumber rn(1234);
+
+    for (int i = 0; i < 20000; i++) {
+        Price price = rn.rndInt(95, 105);
+        Quantity quantity = rn.rndInt(1, 100);
+        Side side = static_cast<Side>(rn.rndInt(0, 1));
+        OrderType orderType = static_cast<OrderType>(rn.rndInt(0, 3));
+        int action = rn.rndInt(0, 9);
+
+        if (action < 2) {
+            OrderId orderId = rn.rndInt(0, i);
+            heapOrderbook.cancelOrder(orderId);
+            otherOrderbook.cancelOrder(orderId);
+            continue;
+        }
+
+        OrderConfirmation heapConfirmation, otherConfirmation;
+        if (action < 4) {
+            OrderId orderId = rn.rndInt(0, i);
+            heapConfirmation = heapOrderbook.modifyOrder(orderId, price, quantity, side);
+            otherConfirmation = otherOrderbook.modifyOrder(orderId, price, quantity, side);
+        } else {
+            heapConfirmation = heapOrderbook.addOrder(price, quantity, side, orderType);
+            otherConfirmation = otherOrderbook.addOrder(price, quantity, side, orderType);
+        }
+
+        assert(heapConfirmation.first == otherConfirmation.first);
+        assert(heapConfirmation.second.size() == otherConfirmation.second.size());
+        for (size_t j = 0; j < heapConfirmation.second.size(); ++j) {
+            Trade& heapTrade = heapConfirmation.second[j];
+            Trade& otherTrade = otherConfirmation.second[j];
+            assert(heapTrade.getBidTrade().orderId == otherTrade.getBidTrade().orderId);
+            assert(heapTrade.getAskTrade().orderId == otherTrade.getAskTrade().orderId);
+            assert(heapTrade.getBidTrade().quantity == otherTrade.getBidTrade().quantity);
+        }
+
+        // liquidity queries agree too
+        if (i % 100 == 0) {
+            for (Side querySide : {Side::Buy, Side::Sell}) {
+                for (std::size_t ticks : {1, 3, 20}) {
+                    assert(heapOrderbook.getBandQuantity(querySide, ticks) == otherOrderbook.getBandQuantity(querySide, ticks));
+                }
+                for (Quantity sweepQuantity : {1, 50, 5000}) {
+                    SweepCost heapCost = heapOrderbook.getSweepCost(querySide, sweepQuantity);
+                    SweepCost otherCost = otherOrderbook.getSweepCost(querySide, sweepQuantity);
+                    assert(heapCost.quantity == otherCost.quantity && heapCost.notional == otherCost.notional);
+                    assert(heapCost.quantity == 0 || heapCost.worstPrice == otherCost.worstPrice);
+                }
+            }
+        }
+    }
+    assert(heapOrderbook.getNumOrders() == otherOrderbook.getNumOrders());
+}
+
+void testDepthKernels() {
+    RandomNumber rn(1234);
+    for (int size : {0, 1, 7, 8, 9, 64, 1000}) {
+        std::vector<Quantity> quantities(size);
+        std::uint64_t total = 0;
+        for (Quantity& quantity : quantities) {
+            quantity = rn.rndInt(0, 2) == 0 ? 0 : rn.rndInt(1, 100); // a third of the ticks empty
+            total += quantity;
+        }
+        assert(sumQuantities(quantities.data(), quantities.size()) == total);
+        assert(sumQuantitiesScalar(quantities.data(), quantities.size()) == total);
+
+        for (std::uint64_t target : {std::uint64_t(1), std::uint64_t(150), total / 2, total, total + 1}) {
+            SweepTotals scalar = sweepQuantitiesScalar(quantities.data(), quantities.size(), target);
+            SweepTotals dispatched = sweepQuantities(quantities.data(), quantities.size(), target);
+            assert(scalar.quantity == std::min(target, total));
+            assert(dispatched.quantity == scalar.quantity && dispatched.weighted == scalar.weighted && dispatched.ticks == scalar.ticks);
+        }
+    }
+    std::cout << "testDepthKernels passed.\n";
+}
+
+template<typename Book>
+void testBandQueries() {
+    Book orderbook;
+    assert(orderbook.getBandQuantity(Side::Buy, 10) == 0);
+    assert(orderbook.getSweepCost(Side::Sell, 10).quantity == 0);
+
+    orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder);
+    orderbook.addOrder(99, 5, Side::Buy, OrderType::LimitOrder);
+    orderbook.addOrder(97, 7, Side::Buy, OrderType::LimitOrder);
+    orderbook.addOrder(102, 4, Side::Sell, OrderType::LimitOrder);
+    orderbook.addOrder(103, 6, Side::Sell, OrderType::LimitOrder);
+    orderbook.addOrder(110, 10, Side::Sell, OrderType::LimitOrder);
+
+    // ticks count from the touch, the best price is the first
+    assert(orderbook.getBandQuantity(Side::Buy, 0) == 0);
+    assert(orderbook.getBandQuantity(Side::Buy, 1) == 10);
+    assert(orderbook.getBandQuantity(Side::Buy, 3) == 15);
+    assert(orderbook.getBandQuantity(Side::Buy, 4) == 22);
+    assert(orderbook.getBandQuantity(Side::Buy, 1000000) == 22);
+    assert(orderbook.getBandQuantity(Side::Sell, 2) == 10);
+
+    // a buy of 7 sweeps 4 @ 102 and 3 @ 103
+    SweepCost cost = orderbook.getSweepCost(Side::Sell, 7);
+    assert(cost.quantity == 7 && cost.notional == 717 && cost.worstPrice == 103);
+    cost = orderbook.getSweepCost(Side::Sell, 100);
+    assert(cost.quantity == 20 && cost.notional == 2126 && cost.worstPrice == 110);
+    cost = orderbook.getSweepCost(Side::Buy, 16);
+    assert(cost.quantity == 16 && cost.notional == 1592 && cost.worstPrice == 97);
+    assert(cost.getVwap() == 99.5);
+
+    // fills and cancels are reflected straight away
+    orderbook.addOrder(99, 12, Side::Sell, OrderType::LimitOrder);
+    assert(orderbook.getBandQuantity(Side::Buy, 10) == 10);
+    cost = orderbook.getSweepCost(Side::Buy, 5);
+    assert(cost.notional == 491 && cost.worstPrice == 97);
+    std::cout << "testBandQueries passed.\n";
+}
+
+template<typename Book>
+void testImmediateOrders() {
+    Book orderbook;
+    LevelUpdates updates;
+    orderbook.setLevelUpdates(&updates);
+    orderbook.addOrder(101, 5, Side::Sell, OrderType::LimitOrder);
+    orderbook.addOrder(102, 5, Side::Sell, OrderType::LimitOrder);
+    orderbook.addOrder(103, 10, Side::Sell, OrderType::LimitOrder);
+    updates.clear();
+
+    // not enough at or below 102: killed before anything is touched
+    Trades trades;
+    assert(orderbook.addOrder(102, 12, Side::Buy, OrderType::FillOrKill, trades) == INVALID_ORDER_ID);
+    assert(trades.empty() && updates.empty());
+    assert(orderbook.getNumOrders() == 3 && orderbook.getPoolStats().inUse == 3);
+
+    // fills in full across two levels (the rejected order used up id 3)
+    assert(orderbook.addOrder(102, 8, Side::Buy, OrderType::FillOrKill, trades) == 4);
+    assert(trades.size() == 2 && trades[1].getAskTrade().price == 102 && trades[1].getBidTrade().quantity == 3);
+    assert(orderbook.getNumOrders() == 2 && orderbook.getBandQuantity(Side::Sell, 1) == 2);
+
+    // fills what it can, the rest never rests
+    trades.clear();
+    assert(orderbook.addOrder(102, 10, Side::Buy, OrderType::ImmediateOrCancel, trades) == 5);
+    assert(trades.size() == 1 && trades[0].getBidTrade().orderId == 5 && trades[0].getBidTrade().quantity == 2);
+    assert(!orderbook.getBestBid().has_value());
+    assert(orderbook.getNumOrders() == 1 && orderbook.getPoolStats().inUse == 1);
+
+    // enough quantity but past the limit, and nothing to take at all
+    assert(orderbook.addOrder(102, 10, Side::Buy, OrderType::FillOrKill, trades) == INVALID_ORDER_ID);
+    assert(orderbook.addOrder(100, 5, Side::Sell, OrderType::ImmediateOrCancel, trades) == INVALID_ORDER_ID);
+    assert(orderbook.getNumOrders() == 1 && orderbook.getBestAsk() == 103);
+    std::cout << "testImmediateOrders passed.\n";
+}
+
+template<typename Book>
+void testStopOrders() {
+    Book orderbook;
+    StopTriggers stopTriggers;
+    orderbook.setStopTriggers(&stopTriggers);
+    auto journal = std::make_unique<Journal>("output/stop_test.bin");
+    orderbook.setJournal(journal.get());
+    orderbook.addOrder(101, 5, Side::Sell, OrderType::LimitOrder);
+    orderbook.addOrder(102, 5, Side::Sell, OrderType::LimitOrder);
+    orderbook.addOrder(103, 5, Side::Sell, OrderType::LimitOrder);
+    orderbook.addOrder(105, 10, Side::Sell, OrderType::LimitOrder);
+
+    Trades trades;
+    assert(orderbook.addStopOrder(102, 5, Side::Buy, trades) == 0);
+    assert(orderbook.addStopLimitOrder(103, 103, 20, Side::Buy, trades) == 1);
+    assert(orderbook.addStopOrder(90, 1, Side::Sell, trades) == 2);
+    assert(trades.empty() && orderbook.getNumStops() == 3);
+
+    // a trade at 101 doesn't reach either buy stop
+    orderbook.addOrder(101, 5, Side::Buy, OrderType::LimitOrder, trades);
+    assert(trades.size() == 1 && orderbook.getNumStops() == 3 && stopTriggers.empty());
+
+    // a trade at 102 fires the stop, whose fills at 103 fire the stop-limit (a cascade)
+    trades.clear();
+    assert(orderbook.addOrder(102, 1, Side::Buy, OrderType::LimitOrder, trades) == 5);
+    assert(trades.size() == 4);
+    assert(trades[1].getBidTrade().orderId == 6 && trades[1].getAskTrade().price == 102 && trades[1].getBidTrade().quantity == 4);
+    assert(trades[2].getBidTrade().orderId == 6 && trades[2].getAskTrade().price == 103 && trades[2].getBidTrade().quantity == 1);
+    assert(trades[3].getBidTrade().orderId == 7 && trades[3].getBidTrade().quantity == 4);
+    assert(stopTriggers.size() == 2);
+    assert(stopTriggers[0].stopId == 0 && stopTriggers[0].orderId == 6);
+    assert(stopTriggers[1].stopId == 1 && stopTriggers[1].orderId == 7);
+    assert(orderbook.getNumStops() == 1);
+
+    // the stop-limit's remainder rests at its limit
+    assert(orderbook.getBestBid() == 103 && orderbook.getBandQuantity(Side::Buy, 1) == 16);
+    assert(orderbook.getBestAsk() == 105);
+
+    assert(orderbook.cancelStopOrder(2));
+    assert(!orderbook.cancelStopOrder(2) && !orderbook.cancelStopOrder(0));
+    assert(orderbook.getNumStops() == 0);
+
+    // the last trade (103) is already at or below this sell stop, so it fires as it is added
+    trades.clear();
+    assert(orderbook.addStopOrder(104, 6, Side::Sell, trades) == 3);
+    assert(trades.size() == 1 && trades[0].getAskTrade().orderId == 8 && trades[0].getBidTrade().price == 103);
+    assert(stopTriggers.size() == 3 && stopTriggers[2].stopId == 3);
+    assert(orderbook.getNumStops() == 0 && orderbook.getBandQuantity(Side::Buy, 1) == 10);
+
+    // triggered stops are journaled as adds, so the journal replays to the same book without the stops
+    orderbook.setJournal(nullptr);
+    journal.reset();
+    std::vector<OrderEvent> events = journalToEvents(Journal::read("output/stop_test.bin"));
+    Book replayed;
+    ReplayReport report = replayEvents(replayed, events.data(), events.data() + events.size(), 0);
+    assert(report.trades == 6);
+    assert(checksumBook(replayed, 0) == checksumBook(orderbook, 0));
+    std::cout << "testStopOrders passed.\n";
+}
+
+void testLadderMatchesHeapEngine() {
+    LadderOrderbook ladderOrderbook;
+    checkMatchesHeapEngine(ladderOrderbook);
+    std::cout << "testLadderMatchesHeapEngine passed.\n";
+}
+
+void testPolicyEngines() {
+    TreeOrderbook treeOrderbook;
+    checkMatchesHeapEngine(treeOrderbook);
+    assert(treeOrderbook.getNumBids() + treeOrderbook.getNumAsks() > 0);
+
+    BasicOrderbook<HeapLevels, SequenceClock, MemoryPool<Order>> memoryPoolOrderbook;
+    checkMatchesHeapEngine(memoryPoolOrderbook);
+    assert(memoryPoolOrderbook.getPoolStats().inUse == memoryPoolOrderbook.getNumOrders());
+
+    // the trade sink and instrumentation see every trade and every operation
+    BasicOrderbook<LadderLevels, TscClock, SlabPool<Order>, TradeCounter, LatencyInstrumentation> instrumented;
+    Trades trades;
+    instrumented.addOrder(100, 10, Side::Buy, OrderType::LimitOrder, trades);
+    instrumented.addOrder(100, 4, Side::Sell, OrderType::LimitOrder, trades);
+    instrumented.addOrder(99, 6, Side::Sell, OrderType::LimitOrder, trades);
+    assert(trades.size() == 2);
+    assert(instrumented.getTradeSink().getTrades() == 2);
+    assert(instrumented.getTradeSink().getVolume() == 10);
+    assert(instrumented.getInstrumentation().getLatency().add.getCount() == 3);
+    assert(instrumented.getInstrumentation().getLatency().match.getCount() == 3);
+
+    BasicOrderbook<LadderLevels, TscClock, SlabPool<Order>, TradeCounter, LatencyInstrumentation> instrumentedReplay;
+    checkMatchesHeapEngine(instrumentedReplay);
+    std::cout << "testPolicyEngines passed.\n";
+}
+
+template<typename Book>
+void testAddOrderBatch() {
+    Book orderbook;
+    OrderRequest requests[] = {
+        {102, 10, Side::Buy, OrderType::LimitOrder},
+        {101, 10, Side::Buy, OrderType::LimitOrder},
+        {100, 10, Side::Buy, OrderType::LimitOrder},
+        {99, 15, Side::Sell, OrderType::LimitOrder},
+        {101, 10, Side::Sell, OrderType::LimitOrder},
+        {90, 5, Side::Sell, OrderType::MarketOrder},
+    };
+    OrderId orderIds[6];
+    Trades trades;
+
+    // 99, 100 and 101 all execute 20 with an imbalance of 10, so the middle price clears
+    std::optional<Price> clearingPrice = orderbook.addOrderBatch(requests, 6, orderIds, trades);
+    assert(clearingPrice && *clearingPrice == 100);
+
+    Quantity volume = 0;
+    for (Trade& trade : trades) {
+        assert(trade.getBidTrade().price == 100);
+        assert(trade.getAskTrade().price == 100);
+        volume += trade.getBidTrade().quantity;
+    }
+    assert(volume == 20);
+
+    // the book is uncrossed: the 100 bid and the 101 ask are left, the market order was filled
+    assert(orderbook.getBestBid() == 100);
+    assert(orderbook.getBestAsk() == 101);
+    assert(orderbook.getNumOrders() == 2);
+
+    // a batch that doesn't cross just rests, and its market orders are cancelled
+    OrderRequest resting[] = {
+        {95, 10, Side::Buy, OrderType::LimitOrder},
+        {105, 10, Side::Sell, OrderType::MarketOrder},
+    };
+    trades.clear();
+    assert(!orderbook.addOrderBatch(resting, 2, orderIds, trades));
+    assert(trades.empty());
+    assert(orderbook.getNumOrders() == 3);
+    std::cout << "testAddOrderBatch passed.\n";
+}
+
+void testLatencyHistogram() {
+    LatencyHistogram histogram;
+    assert(histogram.percentile(50) == 0);
+
+    // 1..1000 once each
+    for (std::uint64_t value = 1; value <= 1000; value++) {
+        histogram.record(value);
+    }
+    assert(histogram.getCount() == 1000);
+    assert(histogram.getMax() == 1000);
+
+    // buckets are within 1/32 of the value they hold
+    std::uint64_t p50 = histogram.percentile(50);
+    std::uint64_t p99 = histogram.percentile(99);
+    assert(p50 >= 500 && p50 <= 500 + 500 / 32);
+    assert(p99 >= 990 && p99 <= 1000);
+    assert(histogram.percentile(100) == 1000);
+
+    // small values are exact, large values still land in a bucket
+    LatencyHistogram small;
+    small.record(7);
+    small.record(UINT64_MAX);
+    assert(small.percentile(50) == 7);
+    assert(small.percentile(100) == UINT64_MAX);
+
+    histogram.merge(small);
+    assert(histogram.getCount() == 1002);
+    histogram.reset();
+    assert(histogram.getCount() == 0 && histogram.getMax() == 0);
+    std::cout << "testLatencyHistogram passed.\n";
+}
+
+template<typename Book>
+void testLevelUpdates() {
+    Book orderbook;
+    LevelUpdates updates;
+    orderbook.setLevelUpdates(&updates);
+
+    OrderId bid = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+    orderbook.addOrder(100, 5, Side::Buy, OrderType::LimitOrder);
+    assert(updates.size() == 2);
+    assert(updates[0].sequence == 1 && updates[0].type == LevelUpdateType::Added && updates[0].quantity == 10);
+    assert(updates[1].sequence == 2 && updates[1].type == LevelUpdateType::Changed && updates[1].quantity == 15);
+
+    // a sell filling both orders deletes the bid level once, its own level comes and goes
+    updates.clear();
+    orderbook.addOrder(100, 15, Side::Sell, OrderType::LimitOrder);
+    assert(updates.size() == 3);
+    assert(updates[0].side == Side::Sell && updates[0].type == LevelUpdateType::Added);
+    assert(updates[1].type == LevelUpdateType::Deleted && updates[2].type == LevelUpdateType::Deleted);
+    assert(updates[2].sequence == 5);
+
+    // the cancel of a filled order publishes nothing
+    updates.clear();
+    orderbook.cancelOrder(bid);
+    assert(updates.empty());
+
+    // a mirror kept from a snapshot and the updates matches the book through random churn
+    MirrorBook mirror;
+    mirror.load(orderbook.getLevelSnapshot());
+    RandomNumber rn(42);
+    std::vector<OrderId> orderIds;
+    for (int i = 0; i < 5000; i++) {
+        updates.clear();
+        int action = rn.rndInt(0, 9);
+        if (action < 2 && !orderIds.empty()) {
+            orderbook.cancelOrder(orderIds[rn.rndInt(0, orderIds.size() - 1)]);
+        } else if (action < 4 && !orderIds.empty()) {
+            Side side = rn.rndInt(0, 1) == 0 ? Side::Buy : Side::Sell;
+            orderIds.push_back(orderbook.modifyOrder(orderIds[rn.rndInt(0, orderIds.size() - 1)], rn.rndInt(90, 110), rn.rndInt(1, 20), side).first);
+        } else {
+            Side side = rn.rndInt(0, 1) == 0 ? Side::Buy : Side::Sell;
+            orderIds.push_back(orderbook.addOrder(rn.rndInt(90, 110), rn.rndInt(1, 20), side, OrderType::LimitOrder).first);
+        }
+        for (const LevelUpdate& update : updates) {
+            mirror.apply(update);
+        }
+
+        LevelSnapshot snapshot = orderbook.getLevelSnapshot();
+        assert(mirror.getSequence() == snapshot.sequence);
+        for (Side side : {Side::Buy, Side::Sell}) {
+            LevelInfos mirrored = mirror.getLevels(side);
+            LevelInfos expected = side == Side::Buy ? snapshot.bids : snapshot.asks;
+            assert(mirrored.size() == expected.size());
+            for (std::size_t j = 0; j < expected.size(); j++) {
+                assert(mirrored[j].price == expected[j].price);
+                assert(mirrored[j].quantity == expected[j].quantity);
+                assert(mirrored[j].orderCount == expected[j].orderCount);
+            }
+        }
+    }
+    std::cout << "testLevelUpdates passed.\n";
+}
+
+void testJournal() {
+    std::vector<JournalRecord> records;
+    {
+        // tiny buffers so the records span several hand offs
+        Journal journal("output/journal_test.bin", 2);
+        Orderbook orderbook;
+        orderbook.setJournal(&journal);
+
+        OrderId bid = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+        orderbook.addOrder(100, 4, Side::Sell, OrderType::LimitOrder);
+        OrderId modified = orderbook.modifyOrder(bid, 99, 8, Side::Buy).first;
+        orderbook.addOrder(105, 1, Side::Buy, OrderType::MarketOrder); // no asks, rejected
+        orderbook.cancelOrder(modified);
+        orderbook.cancelOrder(modified); // already gone, not journalled
+
+        journal.sync();
+        JournalStats stats = journal.getStats();
+        assert(stats.records == 7 && !stats.failed && stats.syncs == 1);
+        assert(stats.bytesWritten == 7 * sizeof(JournalRecord));
+        records = Journal::read("output/journal_test.bin");
+    }
+
+    assert(records.size() == 7);
+    assert(records[0].recordType == JournalRecordType::Add && records[0].orderId == 0 && records[0].quantity == 10);
+    assert(records[1].recordType == JournalRecordType::Add && records[1].orderId == 1 && records[1].side == Side::Sell);
+    assert(records[2].recordType == JournalRecordType::Trade && records[2].orderId == 0 && records[2].otherOrderId == 1);
+    assert(records[2].quantity == 4 && records[2].price == 100 && records[2].otherPrice == 100);
+    assert(records[3].recordType == JournalRecordType::Modify && records[3].orderId == 0 && records[3].otherOrderId == 2);
+    assert(records[3].price == 99 && records[3].quantity == 8);
+    assert(records[4].recordType == JournalRecordType::Add && records[4].orderType == OrderType::MarketOrder && records[4].orderId == 3);
+    assert(records[5].recordType == JournalRecordType::Reject && records[5].orderId == 3);
+    assert(records[6].recordType == JournalRecordType::Cancel && records[6].orderId == 2 && records[6].quantity == 8);
+    std::cout << "testJournal passed.\n";
+}
+
+template<typename Book, typename RestoredBook>
+void testSnapshotRestore() {
+    Book orderbook;
+    RandomNumber rn(7);
+    for (int i = 0; i < 2000; i++) {
+        Side side = rn.rndInt(0, 1) == 0 ? Side::Buy : Side::Sell;
+        OrderId orderId = orderbook.addOrder(rn.rndInt(90, 110), rn.rndInt(1, 50), side, OrderType::LimitOrder).first;
+        if (rn.rndInt(0, 3) == 0) {
+            orderbook.cancelOrder(orderId);
+        }
+    }
+    orderbook.saveSnapshot("output/snapshot_test.bin");
+
+    RestoredBook restored;
+    restored.loadSnapshot("output/snapshot_test.bin");
+    assert(restored.getNumOrders() == orderbook.getNumOrders());
+    LevelSnapshot expected = orderbook.getLevelSnapshot();
+    LevelSnapshot actual = restored.getLevelSnapshot();
+    assert(actual.bids.size() == expected.bids.size() && actual.asks.size() == expected.asks.size());
+    for (std::size_t i = 0; i < expected.bids.size(); i++) {
+        assert(actual.bids[i].price == expected.bids[i].price && actual.bids[i].quantity == expected.bids[i].quantity);
+    }
+
+    // the same orders after the restore give the same ids and trades (time priority was kept)
+    for (int i = 0; i < 2000; i++) {
+        Side side = rn.rndInt(0, 1) == 0 ? Side::Buy : Side::Sell;
+        Price price = rn.rndInt(90, 110);
+        Quantity quantity = rn.rndInt(1, 50);
+        OrderConfirmation original = orderbook.addOrder(price, quantity, side, OrderType::LimitOrder);
+        OrderConfirmation replayed = restored.addOrder(price, quantity, side, OrderType::LimitOrder);
+        assert(original.first == replayed.first);
+        assert(original.second.size() == replayed.second.size());
+        for (std::size_t j = 0; j < original.second.size(); j++) {
+            assert(original.second[j].getBidTrade().orderId == replayed.second[j].getBidTrade().orderId);
+            assert(original.second[j].getAskTrade().orderId == replayed.second[j].getAskTrade().orderId);
+            assert(original.second[j].getBidTrade().quantity == replayed.second[j].getBidTrade().quantity);
+        }
+    }
+
+    // a ladder whose band doesn't cover every price refuses the snapshot and stays empty
+    LadderOrderbook narrowLadder(LadderLevels(95, 105));
+    bool outOfBand = false;
+    try {
+        narrowLadder.loadSnapshot("output/snapshot_test.bin");
+    } catch (const std::out_of_range&) {
+        outOfBand = true;
+    }
+    assert(outOfBand);
+    assert(narrowLadder.getNumOrders() == 0 && narrowLadder.getPoolStats().inUse == 0);
+    assert(narrowLadder.getNumBids() == 0 && narrowLadder.getNumAsks() == 0);
+
+    // only an empty book can be restored into
+    bool threw = false;
+    try {
+        restored.loadSnapshot("output/snapshot_test.bin");
+    } catch (const std::logic_error&) {
+        threw = true;
+    }
+    assert(threw);
+    std::cout << "testSnapshotRestore passed.\n";
+}
+
+void testReplayEngine() {
+    // adds, cancels and modifies of earlier orders (ids are handed out in order by every engine)
+    RandomNumber rn(99);
+    std::vector<OrderEvent> events;
+    for (int i = 0; i < 20000; i++) {
+        OrderEvent event{};
+        int action = rn.rndInt(0, 9);
+        event.eventType = action < 6 ? OrderEventType::Add : (action < 8 ? OrderEventType::Cancel : OrderEventType::Modify);
+        event.side = rn.rndInt(0, 1) == 0 ? Side::Buy : Side::Sell;
+        event.orderType = OrderType::LimitOrder;
+        event.price = rn.rndInt(90, 110);
+        event.quantity = rn.rndInt(1, 50);
+        event.orderId = rn.rndInt(0, i);
+        events.push_back(event);
+    }
+    const OrderEvent* begin = events.data();
+    const OrderEvent* end = events.data() + events.size();
+
+    Orderbook heapOrderbook;
+    LadderOrderbook ladderOrderbook;
+    ReplayReport heapReport = replayEvents(heapOrderbook, begin, end, 1000);
+    ReplayReport ladderReport = replayEvents(ladderOrderbook, begin, end, 1000);
+    assert(heapReport.checkpoints.size() == 20);
+    assert(heapReport.trades > 0);
+    assert(!firstDivergence(heapReport, ladderReport));
+
+    // a changed event shows up at the first checkpoint after it
+    std::vector<OrderEvent> changed = events;
+    changed[4500].quantity += 1;
+    Orderbook changedOrderbook;
+    ReplayReport changedReport = replayEvents(changedOrderbook, changed.data(), changed.data() + changed.size(), 1000);
+    std::optional<std::size_t> divergence = firstDivergence(heapReport, changedReport);
+    assert(divergence && *divergence == 5000);
+
+    // a journal of the run replays to the same checksum
+    {
+        Journal journal("output/replay_test.bin");
+        Orderbook journalOrderbook;
+        journalOrderbook.setJournal(&journal);
+        replayEvents(journalOrderbook, begin, end, 1000);
+    }
+    std::vector<OrderEvent> journalEvents = journalToEvents(Journal::read("output/replay_test.bin"));
+    Orderbook journalReplayOrderbook;
+    ReplayReport journalReport = replayEvents(journalReplayOrderbook, journalEvents.data(), journalEvents.data() + journalEvents.size(), 0);
+    Orderbook originalOrderbook;
+    assert(journalReport.checksum == replayEvents(originalOrderbook, begin, end, 0).checksum);
+    std::cout << "testReplayEngine passed.\n";
+}
+
+template<typename Book>
+void testModifyOrderInPlace() {
+    Book orderbook;
+    OrderId first = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+    OrderId second = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+
+    // amending down at the same price keeps the id and the place in the queue
+    OrderConfirmation amended = orderbook.modifyOrder(first, 100, 4, Side::Buy);
+    assert(amended.first == first);
+    assert(amended.second.empty());
+    assert(orderbook.getNumOrders() == 2);
+    LevelInfo level;
+    orderbook.getDepth(Side::Buy, &level, 1);
+    assert(level.quantity == 14 && level.orderCount == 2);
+
+    Trades trades = orderbook.addOrder(100, 4, Side::Sell, OrderType::LimitOrder).second;
+    assert(trades.size() == 1 && trades[0].getBidTrade().orderId == first);
+    assert(orderbook.getNumOrders() == 1);
+
+    // amending up requeues under a new id behind the orders already there
+    OrderId third = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+    OrderId increased = orderbook.modifyOrder(second, 100, 12, Side::Buy).first;
+    assert(increased != second && increased != INVALID_ORDER_ID);
+    trades = orderbook.addOrder(100, 10, Side::Sell, OrderType::LimitOrder).second;
+    assert(trades.size() == 1 && trades[0].getBidTrade().orderId == third);
+
+    // a new price always requeues
+    OrderId moved = orderbook.modifyOrder(increased, 99, 5, Side::Buy).first;
+    assert(moved != increased);
+    assert(orderbook.getBestBid() == 99);
+    std::cout << "testModifyOrderInPlace passed.\n";
+}
+
+void testTimeSources() {
+    // logical time: one tick per order, the same for every run
+    Orderbook orderbook;
+    OrderId first = orderbook.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+    OrderId second = orderbook.addOrder(99, 10, Side::Buy, OrderType::LimitOrder).first;
+    assert(orderbook.getOrderTime(first) == 1);
+    assert(orderbook.getOrderTime(second) == 2);
+    assert(!orderbook.getOrderTime(INVALID_ORDER_ID).has_value());
+
+    // an in-place amend keeps the time, a requeue gets a new one
+    assert(orderbook.modifyOrder(first, 100, 5, Side::Buy).first == first);
+    assert(orderbook.getOrderTime(first) == 1);
+    OrderId moved = orderbook.modifyOrder(second, 98, 10, Side::Buy).first;
+    assert(orderbook.getOrderTime(moved) == 3);
+
+    // simulation time comes from the caller
+    BasicOrderbook<LadderLevels, SimulationClock> simulated;
+    simulated.getClock().setTime(42);
+    OrderId atFortyTwo = simulated.addOrder(100, 10, Side::Sell, OrderType::LimitOrder).first;
+    simulated.getClock().setTime(43);
+    OrderId atFortyThree = simulated.addOrder(101, 10, Side::Sell, OrderType::LimitOrder).first;
+    assert(simulated.getOrderTime(atFortyTwo) == 42);
+    assert(simulated.getOrderTime(atFortyThree) == 43);
+
+    // cycle counter time never goes backwards
+    BasicOrderbook<HeapLevels, TscClock> timed;
+    OrderId earlier = timed.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+    OrderId later = timed.addOrder(100, 10, Side::Buy, OrderType::LimitOrder).first;
+    assert(*timed.getOrderTime(earlier) <= *timed.getOrderTime(later));
+    std::cout << "testTimeSources passed.\n";
+}
+
 void createhashFile() {
     Orderbook orderbook;
 
@@ -175,9 +909,45 @@ int main() {
     testAddOrder();
     testCancelOrder();
     testModifyOrder();
+    testCancelOrderMiddleOfLevel();
     testGetOrderInfos();
+    testGetDepth<Orderbook>();
+    testGetDepth<LadderOrderbook>();
+    testGetDepth<TreeOrderbook>();
     testMatchOrdersPartialFill();
     testMatchOrdersFullFill();
+    testAddOrderTradeBuffer();
+    testLadderCancelOrder();
+    testLadderPriceBand();
+    testLadderMatchesHeapEngine();
+    testPolicyEngines();
+    testDepthKernels();
+    testImmediateOrders<Orderbook>();
+    testImmediateOrders<LadderOrderbook>();
+    testImmediateOrders<TreeOrderbook>();
+    testStopOrders<Orderbook>();
+    testStopOrders<LadderOrderbook>();
+    testStopOrders<TreeOrderbook>();
+    testBandQueries<Orderbook>();
+    testBandQueries<LadderOrderbook>();
+    testBandQueries<TreeOrderbook>();
+    testAddOrderBatch<Orderbook>();
+    testAddOrderBatch<LadderOrderbook>();
+    testAddOrderBatch<TreeOrderbook>();
+    testLatencyHistogram();
+    testLevelUpdates<Orderbook>();
+    testLevelUpdates<LadderOrderbook>();
+    testLevelUpdates<TreeOrderbook>();
+    testJournal();
+    testSnapshotRestore<Orderbook, Orderbook>();
+    testSnapshotRestore<LadderOrderbook, LadderOrderbook>();
+    testSnapshotRestore<Orderbook, LadderOrderbook>();
+    testSnapshotRestore<LadderOrderbook, TreeOrderbook>();
+    testReplayEngine();
+    testModifyOrderInPlace<Orderbook>();
+    testModifyOrderInPlace<LadderOrderbook>();
+    testModifyOrderInPlace<TreeOrderbook>();
+    testTimeSources();
     // hash file already created, so should compare against original hash file
     // createhashFile();
     hashTest();
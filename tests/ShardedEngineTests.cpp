@@ -0,0 +1,140 @@
+#include "ShardedEngine.h"
+#include "OrderPipeline.h"
+#include "RandomNumber.h"
+#include <cassert>
+#include <iostream>
+
+void testSpscRing() {
+    SpscRing<int> ring(3);
+    assert(ring.capacity() == 4); // rounded up to a power of two
+
+    const int count = 100000;
+    std::thread consumer([&ring] {
+        int expected = 0;
+        int value;
+        while (expected < count) {
+            if (ring.tryPop(value)) {
+                assert(value == expected); // FIFO order
+                ++expected;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (int i = 0; i < count; ++i) {
+        while (!ring.tryPush(i)) {
+            std::this_thread::yield();
+        }
+    }
+    consumer.join();
+    assert(ring.empty());
+    std::cout << "testSpscRing passed.\n";
+}
+
+void testShardedEngineMatchesSerialBooks() {
+    const InstrumentId instruments = 8;
+    RandomNumber rn(1234);
+    std::vector<InstrumentEvent> events;
+    for (int i = 0; i < 20000; ++i) {
+        OrderEvent event{};
+        event.eventType = OrderEventType::Add;
+        event.side = static_cast<Side>(rn.rndInt(0, 1));
+        event.price = rn.rndInt(95, 105);
+        event.quantity = rn.rndInt(1, 100);
+        events.push_back(InstrumentEvent{static_cast<InstrumentId>(rn.rndInt(0, instruments - 1)), event});
+    }
+
+    // serial reference, one book per instrument
+    std::vector<Orderbook> books(instruments);
+    Trades trades;
+    std::size_t serialTrades = 0;
+    for (const auto& event : events) {
+        trades.clear();
+        applyOrderEvent(books[event.instrument], event.event, trades);
+        serialTrades += trades.size();
+    }
+
+    ShardedEngine<Orderbook> engine(3, 64);
+    for (const auto& event : events) {
+        engine.submit(event.instrument, event.event);
+    }
+    engine.flush();
+
+    std::size_t shardedTrades = 0;
+    for (std::size_t shard = 0; shard < engine.getNumShards(); ++shard) {
+        shardedTrades += engine.getShardStats(shard).trades;
+    }
+    assert(shardedTrades == serialTrades);
+    for (InstrumentId instrument = 0; instrument < instruments; ++instrument) {
+        Orderbook* book = engine.getBook(instrument);
+        assert(book != nullptr);
+        assert(book->getNumOrders() == books[instrument].getNumOrders());
+        assert(book->getBestBid() == books[instrument].getBestBid());
+        assert(book->getBestAsk() == books[instrument].getBestAsk());
+    }
+    std::cout << "testShardedEngineMatchesSerialBooks passed.\n";
+}
+
+void testOrderPipelineMatchesInline() {
+    RandomNumber rn(1234);
+    Orderbook inlineBook;
+    Orderbook pipelinedBook;
+    std::vector<OrderCommand> commands;
+    std::vector<ExecutionReport> expected;
+    Trades trades;
+
+    for (std::uint64_t i = 0; i < 5000; ++i) {
+        OrderCommand command{};
+        command.sequence = i;
+        command.event.eventType = OrderEventType::Add;
+        command.event.side = static_cast<Side>(rn.rndInt(0, 1));
+        command.event.price = rn.rndInt(95, 105);
+        command.event.quantity = rn.rndInt(1, 100);
+        commands.push_back(command);
+
+        trades.clear();
+        OrderId orderId = applyOrderEvent(inlineBook, command.event, trades);
+        for (auto& trade : trades) {
+            expected.push_back(ExecutionReport{ReportType::Trade, i, 0, orderId, trade.getBidTrade(), trade.getAskTrade()});
+        }
+        expected.push_back(ExecutionReport{ReportType::Confirmation, i, 0, orderId, TradeInfo{}, TradeInfo{}});
+    }
+
+    std::vector<ExecutionReport> received;
+    ExecutionReport batch[16];
+    {
+        // small rings so the gateway has to poll while submitting
+        OrderPipeline<Orderbook> pipeline(pipelinedBook, 8, false);
+        for (const auto& command : commands) {
+            while (!pipeline.trySubmit(command)) {
+                std::size_t count = pipeline.poll(batch, 16);
+                received.insert(received.end(), batch, batch + count);
+                std::this_thread::yield();
+            }
+        }
+        while (received.size() < expected.size()) {
+            std::size_t count = pipeline.poll(batch, 16);
+            received.insert(received.end(), batch, batch + count);
+            std::this_thread::yield();
+        }
+    }
+
+    assert(received.size() == expected.size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        assert(received[i].reportType == expected[i].reportType);
+        assert(received[i].sequence == expected[i].sequence);
+        assert(received[i].orderId == expected[i].orderId);
+        assert(received[i].bidTrade.orderId == expected[i].bidTrade.orderId);
+        assert(received[i].askTrade.quantity == expected[i].askTrade.quantity);
+    }
+    assert(pipelinedBook.getNumOrders() == inlineBook.getNumOrders());
+    std::cout << "testOrderPipelineMatchesInline passed.\n";
+}
+
+int main() {
+    testSpscRing();
+    testShardedEngineMatchesSerialBooks();
+    testOrderPipelineMatchesInline();
+    std::cout << "All tests passed.\n";
+    return 0;
+}
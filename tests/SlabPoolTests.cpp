@@ -0,0 +1,61 @@
+#include "SlabPool.h"
+#include "Order.h"
+#include <cassert>
+#include <iostream>
+#include <set>
+
+void testAllocateDeallocate() {
+    SlabPool<Order> pool(10);
+    Order* order = pool.allocate();
+    assert(order->getOrderId() == -1); // default constructed
+    assert(pool.getStats().inUse == 1);
+    pool.deallocate(order);
+    assert(pool.getStats().inUse == 0);
+
+    // freed objects are reused first
+    assert(pool.allocate() == order);
+    std::cout << "testAllocateDeallocate passed.\n";
+}
+
+void testHandles() {
+    SlabPool<Order> pool;
+    SlabPool<Order>::Handle first = pool.allocateHandle();
+    SlabPool<Order>::Handle second = pool.allocateHandle();
+    assert(first != second);
+    assert(pool.handleOf(pool.get(first)) == first);
+    assert(pool.handleOf(pool.get(second)) == second);
+
+    // objects in a chunk are contiguous
+    assert(pool.get(second) == pool.get(first) + 1);
+    std::cout << "testHandles passed.\n";
+}
+
+void testChunkGrowthAndStats() {
+    SlabPool<Order, 4096> pool(1);
+    std::size_t chunkCapacity = pool.getStats().capacity;
+    assert(pool.getStats().chunks == 1);
+
+    std::set<SlabPool<Order, 4096>::Handle> handles;
+    for (std::size_t i = 0; i < chunkCapacity * 3; ++i) {
+        Order* order = pool.allocate();
+        handles.insert(pool.handleOf(order));
+    }
+    assert(handles.size() == chunkCapacity * 3); // every handle is unique
+    assert(pool.getStats().chunks == 3);
+    assert(pool.getStats().misses == 2);
+
+    for (auto handle : handles) {
+        pool.deallocate(handle);
+    }
+    assert(pool.getStats().inUse == 0);
+    assert(pool.getStats().highWaterMark == chunkCapacity * 3);
+    std::cout << "testChunkGrowthAndStats passed.\n";
+}
+
+int main() {
+    testAllocateDeallocate();
+    testHandles();
+    testChunkGrowthAndStats();
+    std::cout << "All tests passed.\n";
+    return 0;
+}